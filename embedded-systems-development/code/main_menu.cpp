@@ -2,19 +2,51 @@
 #include <unistd.h>
 #include <iostream>
 #include <csignal>
-#include <sys/wait.h>
+#include <ctime>
+#include <string>
+#include "oled/pantalla.h"
+#include "oled/fuente.h"
+#include "oled/visualizacion.h"
+#include "piano/matriz.h"
+#include "piano/motor_audio.h"
+#include "piano/tiempo_real.h"
+#include "piano/registro.h"
+#include "piano/captura.h"
+#include "piano/metricas.h"
+#include "piano/traza.h"
+#include "tutor/canciones.h"
 
-#define CHIPNAME "gpiochip0"
-#define PIN_IZQ 132
-#define PIN_ENT 133
-#define PIN_DER 134
+#define CONSUMER "piano"
 
-enum EstadoMenu { RAIZ, SELECCION_MODO, MODO_TUTOR, MODO_NORMAL };
+#define TICK_US 5000          // el bucle principal corre cada 5 ms en todos los modos
+#define PAUSA_TUTOR_MS 1000   // la nota correcta suena este tiempo antes de pasar a la siguiente
+
+// Un solo proceso para todo el piano: pide las líneas GPIO, abre el audio y
+// el framebuffer al arrancar y los mantiene hasta salir. Menú, modo normal y
+// tutor son estados de este bucle, así que cambiar de modo no lanza ningún
+// programa ni vuelve a abrir nada.
+
+enum EstadoMenu { RAIZ, MODO_TUTOR, TOCANDO_TUTOR, MODO_NORMAL };
 enum OpcionRaiz { NORMAL, TUTOR };
 enum CancionTutor { ESTRELLITA, HBD, PIRATAS, POLLITOS };
 
 gpiod_chip *chip;
 gpiod_line *btnIzq, *btnEnt, *btnDer;
+Pantalla pantalla;
+bool hayPantalla = false;
+Matriz matriz;
+MotorAudio audio;
+Visualizacion visual;
+CapturaTeclado captura;
+
+volatile sig_atomic_t salir = 0;
+
+// Estado de los modos que tocan
+uint32_t teclasAntes = 0;
+bool vistaEnVivo = false;
+const Cancion* cancionActual = nullptr;
+size_t indiceTutor = 0;
+double pausaHasta = 0;
 
 bool setup() {
     chip = gpiod_chip_open_by_name(CHIPNAME);
@@ -45,76 +77,292 @@ void esperar_liberacion() {
     usleep(150000); // debounce
 }
 
-void mostrar(const std::string& imagen) {
-    if (fork() == 0) {
-        execl(("./" + imagen).c_str(), imagen.c_str(), nullptr);
-        _exit(1);
-    } else {
-        int status;
-        wait(&status);
-    }
+double ahoraMs() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+void mostrar(IdPantalla id) {
+    if (hayPantalla && !pantalla.mostrar(id))
+        registrarTexto("No se pudo actualizar la pantalla");
 }
 
-void ejecutar_con_escape(const std::string& binario) {
-    pid_t pid = fork();
-    if (pid == 0) {
-        execl(("./" + binario).c_str(), binario.c_str(), nullptr);
-        _exit(1);
+IdPantalla pantallaDe(CancionTutor cancion) {
+    switch (cancion) {
+        case ESTRELLITA: return T_ESTRELLITA;
+        case HBD:        return T_HBD;
+        case PIRATAS:    return T_PIRATAS;
+        case POLLITOS:   return T_POLLITOS;
     }
+    return T_ESTRELLITA;
+}
 
-    // Proceso padre: monitorea botones mientras ejecuta el hijo
-    while (true) {
-        if (presionado(btnEnt) && presionado(btnDer)) {
-            kill(pid, SIGTERM);
-            waitpid(pid, nullptr, 0);
-            break;
-        }
+// Tiempo desde que se leyó el botón hasta que el modo quedó listo para tocar
+enum Modo { MODO_MENU, MODO_TOCAR_NORMAL, MODO_TOCAR_TUTOR };
 
-        int status;
-        pid_t result = waitpid(pid, &status, WNOHANG);
-        if (result == pid) break; // terminó naturalmente
+void reportarCambio(Modo destino, double inicio) {
+    registrar(REG_CAMBIO_MODO, destino, int32_t((ahoraMs() - inicio) * 1000));
+}
+
+void publicarNivel(const int16_t* muestras, int frames, void* contexto) {
+    static_cast<Visualizacion*>(contexto)->publicarNivel(nivelPico(muestras, frames));
+}
 
-        usleep(100000); // 100ms
+// Escanea las teclas y manda al audio solo lo que cambió
+uint32_t escanearYTocar() {
+    TRAZA_INICIO(TRAZA_ESCANEO);
+    uint64_t ns = ahoraNs();
+    uint32_t teclas = matriz.escanear();
+    metricas.escaneos.sumar();
+    metricas.escaneo.observar(ahoraNs() - ns);
+    captura.registrar(ns, teclas);
+    uint32_t cambios = teclas ^ teclasAntes;
+    for (int n = 0; n < NUM_NOTAS; ++n) {
+        if (!(cambios & (1u << n))) continue;
+        TRAZA_INSTANTE(TRAZA_TECLA, n + (teclas & (1u << n) ? 32 : 0));
+        if (teclas & (1u << n)) {
+            audio.notaOn(n, ns);
+            registrar(REG_NOTA_ON, n, 0, 0, nombreNota(n));
+        } else {
+            audio.notaOff(n, ns);
+            registrar(REG_NOTA_OFF, n, 0, 0, nombreNota(n));
+        }
     }
+    teclasAntes = teclas;
+    visual.publicarTeclas(teclas);
+    TRAZA_FIN(TRAZA_ESCANEO);
+    return cambios;
+}
+
+// --- Modo normal ---
+
+void entrarNormal() {
+    teclasAntes = 0;
+    vistaEnVivo = false;
+    mostrar(PANTALLA_NORMAL);
+}
 
-    esperar_liberacion();
+// Indicador en el borde derecho y última nota tocada debajo del dibujo
+void dibujarNormal(uint32_t cambios) {
+    for (int n = 0; n < NUM_NOTAS; ++n) {
+        if (!(cambios & (1u << n))) continue;
+        bool presionada = teclasAntes & (1u << n);
+        pantalla.rectangulo(ANCHO_VISIBLE - 3, 14 + 4 * n, 3, 3, presionada);
+        if (presionada) escribirCampo(pantalla, 8, CAMPO_NORMAL_NOTA_R, 8, nombresNotas[n]);
+    }
+    pantalla.actualizar();
 }
 
-void ejecutar(const std::string& binario) {
-    if (fork() == 0) {
-        execl(("./" + binario).c_str(), binario.c_str(), nullptr);
-        _exit(1);
+void alternarVista() {
+    if (!hayPantalla) return;
+    if (vistaEnVivo) {
+        visual.detener();
+        mostrar(PANTALLA_NORMAL);
     } else {
-        int status;
-        wait(&status);
+        visual.iniciar(pantalla);
+    }
+    vistaEnVivo = !vistaEnVivo;
+}
+
+void salirNormal() {
+    audio.silenciar();
+    if (vistaEnVivo) {
+        visual.detener();
+        vistaEnVivo = false;
     }
 }
 
-int main() {
+// --- Tutor ---
+
+void mostrarAvance() {
+    const std::string& nota = cancionActual->notas[indiceTutor];
+    int n = indiceNota(nota);
+    registrar(REG_TUTOR_ESPERA, n, int32_t(indiceTutor + 1), int32_t(cancionActual->notas.size()), nombreNota(n));
+    std::string avance = std::to_string(indiceTutor + 1) + "/" + std::to_string(cancionActual->notas.size());
+    escribirCampo(pantalla, 2, CAMPO_TUTOR_R, CARACTERES_LINEA, ("Toca " + nota).c_str());
+    escribirCampo(pantalla, 2, CAMPO_TUTOR_PROGRESO_R, CARACTERES_LINEA, avance.c_str());
+    pantalla.enviar(false);
+}
+
+void entrarTutor(CancionTutor cancion) {
+    cancionActual = canciones[cancion];
+    indiceTutor = 0;
+    pausaHasta = 0;
+    teclasAntes = 0;
+    matriz.encenderLed(indiceNota(cancionActual->notas[0]));
+    mostrarAvance();
+}
+
+void salirTutor() {
+    audio.silenciar();
+    matriz.apagarLeds();
+}
+
+// Devuelve false cuando la canción terminó
+bool tickTutor() {
+    escanearYTocar();
+    int objetivo = indiceNota(cancionActual->notas[indiceTutor]);
+
+    if (pausaHasta) {
+        if (ahoraMs() < pausaHasta) return true;
+        // Como antes: la nota correcta se corta después de la pausa y, si la
+        // tecla sigue abajo, vuelve a sonar en el próximo escaneo
+        audio.notaOff(objetivo);
+        teclasAntes &= ~(1u << objetivo);
+        pausaHasta = 0;
+        if (++indiceTutor >= cancionActual->notas.size()) {
+            registrar(REG_TUTOR_FIN, int32_t(indiceTutor));
+            return false;
+        }
+        matriz.encenderLed(indiceNota(cancionActual->notas[indiceTutor]));
+        mostrarAvance();
+        return true;
+    }
+
+    if (objetivo >= 0 && (teclasAntes & (1u << objetivo))) pausaHasta = ahoraMs() + PAUSA_TUTOR_MS;
+    return true;
+}
 
-    ejecutar("apagar_leds");
+void alSalir(int) { salir = 1; }
+
+#ifdef TRAZAS
+void alPedirTrazas(int) { Trazas::global().pedirVolcado(); }
+#endif
+
+int main(int argc, char** argv) {
+    ConfigTiempoReal rt;
+    leerConfigTiempoReal(argc, argv, rt);
+    ConfigAlsa alsa;
+    leerConfigAlsa(argc, argv, alsa);
+    if (rt.activo) bloquearMemoria();
+
+    // --registro archivo manda el registro a un archivo en vez de la consola
+    // --capturar archivo guarda lo que lee cada escaneo (ver piano/captura.h)
+    // --metricas socket sirve las métricas en otro socket que RUTA_METRICAS
+    // --trazas prefijo cambia dónde se vuelcan las trazas (compilado con -DTRAZAS)
+    // --cache toca las notas desde los bucles pre-renderizados
+    // --q15 sintetiza en enteros en vez de float
+    // --polifonia N y --robo vieja|suave|grave limitan las voces
+    // --sin-degradar no baja la calidad del audio con sobrecarga
+    const char* archivoRegistro = nullptr;
+    const char* archivoCaptura = nullptr;
+    const char* socketMetricas = RUTA_METRICAS;
+    const char* prefijoTrazas = nullptr;
+    bool usarCache = false;
+    bool usarQ15 = false;
+    bool degradar = true;
+    int polifonia = POLIFONIA;
+    PoliticaRobo politica = ROBAR_VIEJA;
+    for (int i = 1; i < argc; ++i) {
+        std::string opcion = argv[i];
+        if (opcion == "--registro" && i + 1 < argc) archivoRegistro = argv[i + 1];
+        if (opcion == "--capturar" && i + 1 < argc) archivoCaptura = argv[i + 1];
+        if (opcion == "--metricas" && i + 1 < argc) socketMetricas = argv[i + 1];
+        if (opcion == "--trazas" && i + 1 < argc) prefijoTrazas = argv[i + 1];
+        if (opcion == "--cache") usarCache = true;
+        if (opcion == "--q15") usarQ15 = true;
+        if (opcion == "--sin-degradar") degradar = false;
+        if (opcion == "--polifonia" && i + 1 < argc) polifonia = atoi(argv[i + 1]);
+        if (opcion == "--robo" && i + 1 < argc) {
+            int p = indicePolitica(argv[i + 1]);
+            if (p < 0) std::cerr << "Política de robo desconocida: " << argv[i + 1] << "\n";
+            else politica = PoliticaRobo(p);
+        }
+    }
+    Registro::global().iniciar(archivoRegistro);
+    if (archivoCaptura && !captura.abrir(archivoCaptura)) return 1;
+    // Sin métricas el piano funciona igual
+    Metricas::global().servir(socketMetricas);
+#ifdef TRAZAS
+    // IZQUIERDA + DERECHA o SIGUSR1 vuelcan las trazas
+    Trazas::global().iniciar(prefijoTrazas ? prefijoTrazas : PREFIJO_TRAZAS);
+    signal(SIGUSR1, alPedirTrazas);
+#else
+    (void)prefijoTrazas;
+#endif
 
     if (!setup()) {
         std::cerr << "Error al inicializar botones GPIO\n";
         return 1;
     }
 
+    if (!matriz.abrir(CONSUMER)) {
+        std::cerr << "Error al inicializar GPIO\n";
+        return 1;
+    }
+    matriz.apagarLeds();
+
+    // La pantalla es opcional: sin ella el teclado y el audio siguen andando
+    hayPantalla = pantalla.abrir();
+    if (hayPantalla) {
+        pantalla.alEnviar([](uint64_t ns) { metricas.frameOled.observar(ns); });
+    } else {
+        std::cerr << "Error al inicializar la pantalla, se sigue sin ella\n";
+        registrarTexto("Sin pantalla: solo teclado y audio");
+    }
+
+    if (rt.activo) audio.configurarTiempoReal(rt.prioridadAudio, rt.cpuAudio);
+    if (usarCache) audio.fijarModoSintesis(SINTESIS_CACHE);
+    if (usarQ15) audio.fijarAritmetica(ARITMETICA_Q15);
+    audio.fijarPolifonia(polifonia, politica);
+    audio.fijarDegradacion(degradar);
+    if (!audio.abrir(alsa)) {
+        std::cerr << "Error al inicializar audio\n";
+        return 1;
+    }
+    audio.imprimirConfiguracion();
+    audio.observar(publicarNivel, &visual);
+
+    // Este hilo escanea teclas, maneja LEDs y pantalla: el otro núcleo
+    if (rt.activo) {
+        fijarTiempoReal(rt.prioridadEscaneo, rt.cpuEscaneo, "escaneo");
+        prefaultPila();
+    }
+
+    signal(SIGINT, alSalir);
+    signal(SIGTERM, alSalir);
+    TRAZA_NOMBRE_HILO("escaneo");
+
     EstadoMenu estado = RAIZ;
     OpcionRaiz opcion = NORMAL;
     CancionTutor cancion = ESTRELLITA;
 
-    mostrar("o_menu_normal");
+    mostrar(MENU_NORMAL);
+
+    int codigo = 0;
+    while (!salir) {
+        // Sin audio el piano no sirve: se sale con error para que quien lo
+        // lanzó (el servicio) lo vuelva a arrancar
+        if (!audio.funcionando()) {
+            std::cerr << "El audio se detuvo y no volvió, se sale\n";
+            registrarTexto("El audio se detuvo y no volvió, se sale");
+            codigo = 1;
+            break;
+        }
 
-    while (true) {
         bool izq = presionado(btnIzq);
         bool der = presionado(btnDer);
         bool ent = presionado(btnEnt);
+        double inicio = ahoraMs();
+
+#ifdef TRAZAS
+        if (izq && der && !ent) {
+            Trazas::global().pedirVolcado();
+            esperar_liberacion();
+            continue;
+        }
+#endif
 
         // Volver atrás si se presionan ENTER + DERECHA
         if (ent && der) {
-            if (estado == MODO_TUTOR || estado == MODO_NORMAL) {
+            if (estado == MODO_TUTOR || estado == TOCANDO_TUTOR || estado == MODO_NORMAL) {
+                if (estado == MODO_NORMAL) salirNormal();
+                if (estado == TOCANDO_TUTOR) salirTutor();
                 estado = RAIZ;
-                mostrar("o_menu_normal");
+                opcion = NORMAL;
+                mostrar(MENU_NORMAL);
+                reportarCambio(MODO_MENU, inicio);
                 esperar_liberacion();
                 continue;
             }
@@ -123,59 +371,77 @@ int main() {
         if (estado == RAIZ) {
             if (izq || der) {
                 opcion = (opcion == NORMAL) ? TUTOR : NORMAL;
-                mostrar(opcion == NORMAL ? "o_menu_normal" : "o_menu_tutor");
+                mostrar(opcion == NORMAL ? MENU_NORMAL : MENU_TUTOR);
                 esperar_liberacion();
             } else if (ent) {
                 if (opcion == NORMAL) {
-                    mostrar("o_normal");
                     estado = MODO_NORMAL;
-                    ejecutar_con_escape("read_notes");
-                    mostrar("o_menu_normal");
-                    estado = RAIZ;
+                    entrarNormal();
+                    reportarCambio(MODO_TOCAR_NORMAL, inicio);
                 } else {
                     estado = MODO_TUTOR;
                     cancion = ESTRELLITA;
-                    mostrar("o_t_estrellita");
-                    esperar_liberacion();
+                    mostrar(T_ESTRELLITA);
                 }
+                esperar_liberacion();
             }
         }
 
         else if (estado == MODO_TUTOR) {
             if (izq) {
                 cancion = static_cast<CancionTutor>((cancion + 3) % 4);
-                switch (cancion) {
-                    case ESTRELLITA: mostrar("o_t_estrellita"); break;
-                    case HBD:         mostrar("o_t_hbd"); break;
-                    case PIRATAS:     mostrar("o_t_piratas"); break;
-                    case POLLITOS:    mostrar("o_t_pollitos"); break;
-                }
+                mostrar(pantallaDe(cancion));
                 esperar_liberacion();
             } else if (der) {
                 cancion = static_cast<CancionTutor>((cancion + 1) % 4);
-                switch (cancion) {
-                    case ESTRELLITA: mostrar("o_t_estrellita"); break;
-                    case HBD:         mostrar("o_t_hbd"); break;
-                    case PIRATAS:     mostrar("o_t_piratas"); break;
-                    case POLLITOS:    mostrar("o_t_pollitos"); break;
-                }
+                mostrar(pantallaDe(cancion));
                 esperar_liberacion();
             } else if (ent) {
-                switch (cancion) {
-                    case ESTRELLITA: ejecutar("t_estrellita"); break;
-                    case HBD:         ejecutar("t_hbd"); break;
-                    case PIRATAS:     ejecutar("t_piratas"); break;
-                    case POLLITOS:    ejecutar("t_pollitos"); break;
-                }
-                mostrar("o_menu_normal");
+                estado = TOCANDO_TUTOR;
+                entrarTutor(cancion);
+                reportarCambio(MODO_TOCAR_TUTOR, inicio);
+                esperar_liberacion();
+            }
+        }
+
+        else if (estado == TOCANDO_TUTOR) {
+            if (!tickTutor()) {
+                salirTutor();
+                mostrar(MENU_NORMAL);
                 estado = RAIZ;
+                opcion = NORMAL;
+            }
+        }
+
+        else if (estado == MODO_NORMAL) {
+            // IZQUIERDA alterna entre la imagen con campos y la vista en vivo
+            if (izq && !ent) {
+                alternarVista();
                 esperar_liberacion();
+                continue;
             }
+            uint32_t cambios = escanearYTocar();
+            if (!vistaEnVivo) dibujarNormal(cambios);
         }
 
-        usleep(100000); // 100ms
+        usleep(TICK_US);
     }
 
+    salirNormal();
+    salirTutor();
+    audio.cerrar();
+    audio.imprimirEstadisticas();
+    pantalla.cerrar();
+    matriz.cerrar();
     gpiod_chip_close(chip);
-    return 0;
+    if (captura.activa()) {
+        captura.cerrar();
+        std::cout << "Captura: " << captura.escaneos() << " escaneos, " << captura.escaneosDescartados() << " descartados\n";
+    }
+    Metricas::global().detener();
+#ifdef TRAZAS
+    Trazas::global().detener();
+#endif
+    Registro::global().detener();
+    return codigo;
 }
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+# Convierte las imágenes PNG de o_images en un solo paquete para la pantalla OLED.
+#
+# Las imágenes se dibujan como se ven en el piano: 64 x 128, vertical, blanco =
+# pixel encendido. Este script las lleva al orden del framebuffer (girada y
+# espejada, 16 bytes por fila, bit menos significativo primero), así que ya no
+# hay que espejarlas a mano. Cada pantalla se comprime con RLE (PackBits).
+#
+# Uso: python3 empaquetar_imagenes.py [carpeta_png] [salida.pak]
+#
+# Formato del paquete (little endian):
+#   "OLED", versión (u16), número de pantallas (u16)
+#   por pantalla: nombre (24 bytes, relleno con ceros), offset (u32), largo (u32)
+#   datos comprimidos
+# Con una pantalla nueva basta agregar su PNG y volver a correr el script.
+
+import os
+import struct
+import sys
+import zlib
+
+ANCHO_VISIBLE = 64
+ALTO_VISIBLE = 128
+FB_ANCHO = 128
+FB_ALTO = 64
+FB_SIZE = FB_ANCHO * FB_ALTO // 8
+LARGO_NOMBRE = 24
+
+
+def leer_png(ruta):
+    datos = open(ruta, 'rb').read()
+    if datos[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('%s no es un PNG' % ruta)
+
+    p = 8
+    idat = b''
+    while p < len(datos):
+        largo, = struct.unpack('>I', datos[p:p + 4])
+        tipo = datos[p + 4:p + 8]
+        cuerpo = datos[p + 8:p + 8 + largo]
+        if tipo == b'IHDR':
+            ancho, alto, bits, color, _, _, entrelazado = struct.unpack('>IIBBBBB', cuerpo)
+        elif tipo == b'IDAT':
+            idat += cuerpo
+        p += 12 + largo
+
+    if bits != 8 or entrelazado or color not in (0, 2, 4, 6):
+        raise ValueError('%s: solo se soportan PNG de 8 bits sin entrelazar (gris, RGB, con o sin alfa)' % ruta)
+
+    canales = {0: 1, 2: 3, 4: 2, 6: 4}[color]
+    paso = ancho * canales
+    crudo = zlib.decompress(idat)
+
+    filas = []
+    anterior = bytearray(paso)
+    i = 0
+    for _ in range(alto):
+        filtro = crudo[i]
+        fila = bytearray(crudo[i + 1:i + 1 + paso])
+        i += 1 + paso
+        for x in range(paso):
+            a = fila[x - canales] if x >= canales else 0
+            b = anterior[x]
+            c = anterior[x - canales] if x >= canales else 0
+            if filtro == 1:
+                fila[x] = (fila[x] + a) & 0xFF
+            elif filtro == 2:
+                fila[x] = (fila[x] + b) & 0xFF
+            elif filtro == 3:
+                fila[x] = (fila[x] + (a + b) // 2) & 0xFF
+            elif filtro == 4:
+                pa, pb, pc = abs(b - c), abs(a - c), abs(a + b - 2 * c)
+                fila[x] = (fila[x] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        filas.append(fila)
+        anterior = fila
+
+    # Un pixel está encendido si es claro y no es transparente
+    pixeles = []
+    for fila in filas:
+        linea = []
+        for x in range(ancho):
+            px = fila[x * canales:(x + 1) * canales]
+            if color in (0, 4):
+                luz, alfa = px[0], (px[1] if color == 4 else 255)
+            else:
+                luz, alfa = sum(px[:3]) // 3, (px[3] if color == 6 else 255)
+            linea.append(luz >= 128 and alfa >= 128)
+        pixeles.append(linea)
+    return ancho, alto, pixeles
+
+
+# La columna c y la fila r que se ven son el pixel x = 127 - r, y = 63 - c
+def a_framebuffer(pixeles):
+    fb = bytearray(FB_SIZE)
+    for r in range(ALTO_VISIBLE):
+        for c in range(ANCHO_VISIBLE):
+            if pixeles[r][c]:
+                x = FB_ANCHO - 1 - r
+                y = FB_ALTO - 1 - c
+                fb[y * (FB_ANCHO // 8) + x // 8] |= 1 << (x % 8)
+    return bytes(fb)
+
+
+# PackBits: 0..127 = copiar n+1 bytes, 128..255 = repetir el siguiente byte n-125 veces
+def comprimir(datos):
+    salida = bytearray()
+    literal = bytearray()
+    i = 0
+    while i < len(datos):
+        n = 1
+        while i + n < len(datos) and datos[i + n] == datos[i] and n < 130:
+            n += 1
+        if n >= 3:
+            while literal:
+                bloque = literal[:128]
+                salida.append(len(bloque) - 1)
+                salida += bloque
+                literal = literal[128:]
+            salida.append(n + 125)
+            salida.append(datos[i])
+            i += n
+        else:
+            literal.append(datos[i])
+            i += 1
+    while literal:
+        bloque = literal[:128]
+        salida.append(len(bloque) - 1)
+        salida += bloque
+        literal = literal[128:]
+    return bytes(salida)
+
+
+def main():
+    carpeta = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), 'o_images')
+    salida = sys.argv[2] if len(sys.argv) > 2 else os.path.join(os.path.dirname(__file__), 'imagenes.pak')
+
+    entradas = []
+    for archivo in sorted(os.listdir(carpeta)):
+        if not archivo.lower().endswith('.png'):
+            continue
+        nombre = os.path.splitext(archivo)[0]
+        ancho, alto, pixeles = leer_png(os.path.join(carpeta, archivo))
+        if (ancho, alto) != (ANCHO_VISIBLE, ALTO_VISIBLE):
+            raise SystemExit('%s mide %dx%d, debe ser %dx%d' % (archivo, ancho, alto, ANCHO_VISIBLE, ALTO_VISIBLE))
+        codificado = nombre.encode('utf-8')
+        if len(codificado) >= LARGO_NOMBRE:
+            raise SystemExit('%s: el nombre es muy largo' % archivo)
+        entradas.append((codificado, comprimir(a_framebuffer(pixeles))))
+
+    cabecera = struct.pack('<4sHH', b'OLED', 1, len(entradas))
+    offset = len(cabecera) + len(entradas) * (LARGO_NOMBRE + 8)
+    indice = b''
+    datos = b''
+    for nombre, comprimido in entradas:
+        indice += struct.pack('<%dsII' % LARGO_NOMBRE, nombre, offset + len(datos), len(comprimido))
+        datos += comprimido
+
+    with open(salida, 'wb') as f:
+        f.write(cabecera + indice + datos)
+
+    total = len(cabecera) + len(indice) + len(datos)
+    print('%d pantallas, %d bytes (sin comprimir serían %d)' % (len(entradas), total, len(entradas) * FB_SIZE))
+
+
+if __name__ == '__main__':
+    main()
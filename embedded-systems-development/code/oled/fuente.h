@@ -0,0 +1,159 @@
+#ifndef FUENTE_H
+#define FUENTE_H
+
+#include <cstdint>
+#include <cstring>
+#include "pantalla.h"
+
+// Texto 5x7 para la pantalla OLED, en las coordenadas que ve el usuario
+// (c de 0 a 63, r de 0 a 127). Cada carácter ocupa una celda de 6 x 8.
+#define ANCHO_GLIFO 5
+#define AVANCE_GLIFO 6
+#define ALTO_LINEA 8
+#define PRIMER_GLIFO 32
+#define NUM_GLIFOS 95
+#define CARACTERES_LINEA (ANCHO_VISIBLE / AVANCE_GLIFO)
+
+// ASCII de ' ' a '~', una columna por byte, bit 0 = fila de arriba
+constexpr uint8_t glifos5x7[NUM_GLIFOS][ANCHO_GLIFO] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, // ' ' ! "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // # $ %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00}, // & ' (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08}, // ) * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, // , - .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, // / 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10}, // 2 3 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 5 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, // 8 9 :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // ; < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E}, // > ? @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, // A B C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, // D E F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, // G H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40}, // J K L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, // M N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, // P Q R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, // S T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63}, // V W X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00}, // Y Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, // \ ] ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // _ ` a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F}, // b c d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E}, // e f g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, // h i j
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, // k l m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08}, // n o p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // q r s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, // t u v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, // w x y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00}, // z { |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x04, 0x08, 0x10, 0x08}                                  // } ~
+};
+
+// Una columna de un glifo cae en una sola fila del framebuffer con x
+// decreciendo hacia abajo, así que el atlas guarda cada columna con los bits
+// invertidos: si la celda empieza en una fila múltiplo de 8, es un byte listo
+// para hacer OR en la sombra.
+constexpr uint8_t invertirBits(uint8_t b) {
+    uint8_t r = 0;
+    for (int i = 0; i < 8; ++i)
+        if (b & (1 << i)) r |= uint8_t(0x80 >> i);
+    return r;
+}
+
+struct AtlasFuente {
+    uint8_t columnas[NUM_GLIFOS][ANCHO_GLIFO];
+};
+
+constexpr AtlasFuente construirAtlas() {
+    AtlasFuente a{};
+    for (int g = 0; g < NUM_GLIFOS; ++g)
+        for (int i = 0; i < ANCHO_GLIFO; ++i)
+            a.columnas[g][i] = invertirBits(glifos5x7[g][i]);
+    return a;
+}
+
+constexpr AtlasFuente atlas = construirAtlas();
+
+// Glifo de un byte de texto; lo que no es ASCII imprimible se dibuja como '?'
+inline const uint8_t* glifoDe(unsigned char ch) {
+    if (ch < PRIMER_GLIFO || ch >= PRIMER_GLIFO + NUM_GLIFOS) ch = '?';
+    return atlas.columnas[ch - PRIMER_GLIFO];
+}
+
+// Cuántos caracteres se dibujan; los bytes de continuación UTF-8 no cuentan
+inline int largoTexto(const char* texto) {
+    int n = 0;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(texto); *p; ++p)
+        if ((*p & 0xC0) != 0x80) ++n;
+    return n;
+}
+
+// Aplica una columna de 8 bits en la fila y del framebuffer para la fila
+// visible r. Con r múltiplo de 8 es un solo byte; si no, se reparte en dos.
+inline void aplicarColumna(uint8_t* fila, int r, uint8_t bits, uint8_t mascara) {
+    int byte = (WIDTH - 1 - r) / 8;
+    int s = r % 8;
+    fila[byte] = uint8_t((fila[byte] & ~(mascara >> s)) | (bits >> s));
+    if (s && byte > 0)
+        fila[byte - 1] = uint8_t((fila[byte - 1] & ~(mascara << (8 - s))) | (bits << (8 - s)));
+}
+
+// Dibuja una línea de texto con la esquina de arriba a la izquierda en (c, r),
+// borrando el fondo de cada celda. Lo que sale del ancho se recorta.
+// Devuelve la columna donde terminó.
+inline int dibujarTexto(Pantalla& pantalla, int c, int r, const char* texto) {
+    if (r < 0 || r > ALTO_VISIBLE - ALTO_LINEA) return c;
+    uint8_t* sombra = pantalla.datos();
+    int inicio = c;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(texto); *p && c < ANCHO_VISIBLE; ++p) {
+        if ((*p & 0xC0) == 0x80) continue;
+        const uint8_t* glifo = glifoDe(*p);
+        for (int i = 0; i < AVANCE_GLIFO; ++i, ++c) {
+            if (c < 0 || c >= ANCHO_VISIBLE) continue;
+            uint8_t* fila = sombra + (HEIGHT - 1 - c) * BYTES_FILA;
+            aplicarColumna(fila, r, i < ANCHO_GLIFO ? glifo[i] : 0, 0xFF);
+        }
+    }
+    int fin = c < ANCHO_VISIBLE ? c : ANCHO_VISIBLE;
+    if (fin > inicio) pantalla.marcarFilas(HEIGHT - fin, HEIGHT - 1 - (inicio > 0 ? inicio : 0));
+    return c;
+}
+
+// Borra una celda de texto de n caracteres
+inline void borrarTexto(Pantalla& pantalla, int c, int r, int caracteres) {
+    if (r < 0 || r > ALTO_VISIBLE - ALTO_LINEA) return;
+    uint8_t* sombra = pantalla.datos();
+    int fin = c + caracteres * AVANCE_GLIFO;
+    if (c < 0) c = 0;
+    if (fin > ANCHO_VISIBLE) fin = ANCHO_VISIBLE;
+    for (int i = c; i < fin; ++i)
+        aplicarColumna(sombra + (HEIGHT - 1 - i) * BYTES_FILA, r, 0, 0xFF);
+    if (fin > c) pantalla.marcarFilas(HEIGHT - fin, HEIGHT - 1 - c);
+}
+
+// Campo de una pantalla plantilla: un espacio fijo de n caracteres sobre la
+// imagen del paquete. El texto se centra y lo que sobra se borra, así un valor
+// más corto no deja restos del anterior.
+inline void escribirCampo(Pantalla& pantalla, int c, int r, int caracteres, const char* texto) {
+    int largo = largoTexto(texto);
+    if (largo > caracteres) largo = caracteres;
+    borrarTexto(pantalla, c, r, caracteres);
+    int inicio = c + (caracteres - largo) * AVANCE_GLIFO / 2;
+    char recortado[CARACTERES_LINEA * 4 + 1];
+    size_t n = 0;
+    int contados = 0;
+    for (const char* p = texto; *p && n + 1 < sizeof(recortado); ++p) {
+        if ((*p & 0xC0) != 0x80 && contados++ == largo) break;
+        recortado[n++] = *p;
+    }
+    recortado[n] = '\0';
+    dibujarTexto(pantalla, inicio, r, recortado);
+}
+
+// Campos de las pantallas plantilla, debajo del dibujo de cada una
+#define CAMPO_NORMAL_NOTA_R 112
+#define CAMPO_TUTOR_R 112
+#define CAMPO_TUTOR_PROGRESO_R 120
+
+#endif
@@ -1,94 +1,15 @@
 #include <iostream>
-#include <fcntl.h>
-#include <unistd.h>
-#include <cstring>
-
-// Copia aquí el array generado por Image2cpp:
-const unsigned char epd_bitmap[] = {
-// 'menu_normal', 64x128px
-0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0xe0, 0xff, 0xff, 0x3f, 0xf8, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3f, 0xc0, 0xff, 0xff, 0x0f, 0xf0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3f, 0xc0, 0xff, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xc7, 0xe3, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe7, 0xe7, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xcf, 0xff, 0xff, 0xff, 0x00, 0x00, 0xf8, 0xff, 0xc7, 0xe3, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0xe0, 0xff, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x07, 0xf0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0xf0, 0xff, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x0f, 0xf8, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x1f, 0xfc, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0x3c, 0xfc, 0xff, 0x00, 0x00, 0xf0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0x1c, 0xf8, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0xff, 0xef, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xcf, 0xdc, 0xf9, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0x1e, 0xfc, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x1f, 0x3f, 0xfe, 0xff, 0x00, 0x00, 0xf0, 0xff, 0x07, 0xfe, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0xfc, 0xc7, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0x1f, 0xf8, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0x1c, 0xc0, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x7f, 0xe0, 0xff, 0xff, 0xe7, 0xff, 
-    0xff, 0xff, 0xff, 0x1e, 0xf9, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xe7, 0xff, 
-    0xff, 0xff, 0x0f, 0x9c, 0xf9, 0xff, 0x00, 0x00, 0xf0, 0xff, 0x07, 0xe0, 0xff, 0xff, 0x0f, 0xfc, 
-    0xff, 0xff, 0x0f, 0x1c, 0xfc, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0x07, 0xfc, 0xff, 0xff, 0xff, 0xf9, 
-    0xff, 0xff, 0xff, 0x3e, 0xfe, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfd, 
-    0xff, 0xff, 0x0f, 0x3c, 0xfc, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0xc7, 0xff, 0x1f, 0x00, 0x00, 0xfc, 
-    0xff, 0xff, 0x0f, 0x1c, 0xf8, 0xff, 0x00, 0x00, 0xf0, 0xff, 0x07, 0xf0, 0x0f, 0xfe, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xdc, 0xfb, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0x07, 0xe0, 0x07, 0xfe, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0x1e, 0xf8, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x0f, 0xe0, 0x07, 0xfe, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0x3c, 0xfc, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x8f, 0xe0, 0x07, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0x3c, 0xfc, 0xff, 0x00, 0x00, 0xf0, 0xff, 0x0f, 0xe0, 0x07, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0x1f, 0xf8, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x07, 0xfc, 0x07, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x1f, 0xfe, 0xf9, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x87, 0xff, 0xcf, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0x3c, 0xfc, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0xf7, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xef, 0x1c, 0xf8, 0xff, 0x00, 0x00, 0xf0, 0xff, 0xff, 0xef, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0xfe, 0xf9, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x1f, 0x3f, 0xf8, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x1f, 0x1e, 0xf8, 0xff, 0x00, 0x00, 0xf0, 0xff, 0x07, 0xfc, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0xfc, 0xff, 0xff, 0x00, 0x00, 0xf0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xfc, 0xff, 0xff, 0x3e, 0x00, 0xf0, 0xff, 0xff, 0xf0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x1f, 0xfc, 0xff, 0xff, 0xfe, 0xff, 0xf3, 0xff, 0x7f, 0xf0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0x0f, 0xfc, 0xff, 0xff, 0x00, 0x00, 0xf0, 0xff, 0x3f, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0xf8, 0xff, 0x3f, 0xe7, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3f, 0xe3, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3f, 0xc0, 0xff, 0xff, 0x07, 0xe0, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3f, 0xc0, 0xff, 0xff, 0x07, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0xe0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
-};
+#include "pantalla.h"
 
 int main() {
-    const char *fb_path = "/dev/fb1";
-    int fb = open(fb_path, O_WRONLY);
+    Pantalla pantalla;
+    if (!pantalla.abrir()) return 1;
 
-    if (fb < 0) {
-        perror("No se pudo abrir el framebuffer");
-        return 1;
+    if (!pantalla.mostrar(MENU_NORMAL)) {
+        std::cerr << "Advertencia: no se pudo escribir la imagen completa\n";
     }
 
-    ssize_t bytes_written = write(fb, epd_bitmap, sizeof(epd_bitmap));
-
-    if (bytes_written != sizeof(epd_bitmap)) {
-        std::cerr << "Advertencia: solo se escribieron " << bytes_written << " bytes\n";
-    }
-
-    close(fb);
+    pantalla.cerrar();
     std::cout << "Imagen mostrada en OLED\n";
     return 0;
 }
-
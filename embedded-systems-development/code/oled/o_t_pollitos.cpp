@@ -1,94 +1,15 @@
 #include <iostream>
-#include <fcntl.h>
-#include <unistd.h>
-#include <cstring>
-
-// Copia aquí el array generado por Image2cpp:
-const unsigned char epd_bitmap[] = {
-    // 'Screenshot from 2025-07-22 11-08-00', 128x64px
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x00, 0x00, 0x40, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x01, 0x00, 0xc0, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc7, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xce, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x5e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x7a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0x00, 0x00, 0x20, 0x00, 0x00, 
-    0x00, 0x00, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 
-    0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e, 0x00, 0x00, 0x70, 0x00, 0x00, 
-    0x00, 0x00, 0x7c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x7f, 0x00, 0x00, 0x78, 0x00, 0x00, 
-    0x00, 0x00, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xff, 0x00, 0x00, 0xf8, 0x00, 0x00, 
-    0x00, 0x00, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0x00, 0xf8, 0xfd, 0x00, 0x00, 
-    0x00, 0x00, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0xc0, 0xc0, 0x00, 0xfc, 0xfd, 0x01, 0x00, 
-    0x00, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x00, 0x7c, 0x00, 0xc0, 0xe0, 0x00, 0xfc, 0xfc, 0x01, 0x00, 
-    0x00, 0x00, 0x46, 0x98, 0x00, 0x00, 0x60, 0xff, 0x00, 0xc0, 0x7f, 0x00, 0xfc, 0xfe, 0x01, 0x00, 
-    0x00, 0x00, 0xfe, 0xbc, 0x00, 0x00, 0xfe, 0xff, 0x01, 0x80, 0x3f, 0x00, 0xfe, 0xfe, 0x03, 0x00, 
-    0x00, 0x00, 0x7c, 0xe4, 0x00, 0x00, 0xff, 0xff, 0x01, 0x00, 0x0f, 0x00, 0x7e, 0xff, 0x03, 0x00, 
-    0x00, 0x00, 0x00, 0x04, 0x00, 0x80, 0xff, 0xff, 0x01, 0x00, 0xc0, 0x00, 0x7e, 0xff, 0x07, 0x00, 
-    0x00, 0x00, 0x70, 0x71, 0x00, 0xc4, 0xff, 0xff, 0x01, 0x00, 0xc0, 0x00, 0xbf, 0xff, 0x07, 0x00, 
-    0x00, 0x00, 0xfe, 0xfd, 0x00, 0xe6, 0xff, 0xff, 0x01, 0x00, 0xc0, 0x80, 0xbf, 0xff, 0x0f, 0x00, 
-    0x00, 0x00, 0x00, 0x84, 0x00, 0xfc, 0xff, 0xff, 0x01, 0xc0, 0xff, 0x80, 0xdf, 0xff, 0x0f, 0x00, 
-    0x00, 0x00, 0x06, 0xfc, 0x00, 0xfe, 0xbf, 0xff, 0x00, 0xc0, 0xff, 0x80, 0xdf, 0xff, 0x0f, 0x00, 
-    0x00, 0x00, 0xfe, 0x3b, 0x80, 0xf3, 0x7f, 0x3f, 0x00, 0xc0, 0xef, 0x80, 0xbf, 0xff, 0x0f, 0x00, 
-    0x00, 0x00, 0x1c, 0x04, 0x00, 0xff, 0xfb, 0x0f, 0x00, 0x00, 0xc0, 0x00, 0xbf, 0xff, 0x07, 0x00, 
-    0x00, 0x00, 0x06, 0x04, 0x00, 0xff, 0xfb, 0x0f, 0x00, 0x00, 0xc0, 0x00, 0x3f, 0xff, 0x07, 0x00, 
-    0x00, 0x00, 0xfe, 0x07, 0x00, 0xf0, 0xfb, 0x07, 0x00, 0x00, 0x00, 0x00, 0x7e, 0xff, 0x07, 0x00, 
-    0x00, 0x00, 0x1c, 0xfc, 0x03, 0xf0, 0xfb, 0x07, 0x00, 0x00, 0x00, 0x00, 0x7e, 0xff, 0x03, 0x00, 
-    0x00, 0x00, 0x38, 0xfc, 0x01, 0xf0, 0xfb, 0x03, 0x00, 0x00, 0xff, 0x00, 0xfc, 0xfe, 0x03, 0x00, 
-    0x00, 0x00, 0x7e, 0x00, 0x00, 0xe0, 0xff, 0x01, 0x00, 0x80, 0xff, 0x00, 0xfc, 0xfe, 0x01, 0x00, 
-    0x00, 0x00, 0x42, 0x00, 0x00, 0xc0, 0xe7, 0x00, 0x00, 0xc0, 0x03, 0x00, 0xfc, 0xfd, 0x01, 0x00, 
-    0x00, 0x00, 0x7e, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0xc0, 0x00, 0x00, 0xfc, 0xfd, 0x00, 0x00, 
-    0x00, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 
-    0x00, 0x00, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0x70, 0x00, 0x78, 0x00, 0x00, 
-    0x00, 0x00, 0xf0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xf0, 0x03, 0x78, 0x00, 0x00, 
-    0x00, 0x00, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0xf0, 0x01, 0x70, 0x00, 0x00, 
-    0x00, 0x00, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x30, 0x00, 0x30, 0x00, 0x00, 
-    0x00, 0x00, 0xfe, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x20, 0x00, 0x00, 
-    0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x03, 0x00, 0xc0, 0xef, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x01, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+#include "pantalla.h"
 
 int main() {
-    const char *fb_path = "/dev/fb1";
-    int fb = open(fb_path, O_WRONLY);
+    Pantalla pantalla;
+    if (!pantalla.abrir()) return 1;
 
-    if (fb < 0) {
-        perror("No se pudo abrir el framebuffer");
-        return 1;
+    if (!pantalla.mostrar(T_POLLITOS)) {
+        std::cerr << "Advertencia: no se pudo escribir la imagen completa\n";
     }
 
-    ssize_t bytes_written = write(fb, epd_bitmap, sizeof(epd_bitmap));
-
-    if (bytes_written != sizeof(epd_bitmap)) {
-        std::cerr << "Advertencia: solo se escribieron " << bytes_written << " bytes\n";
-    }
-
-    close(fb);
+    pantalla.cerrar();
     std::cout << "Imagen mostrada en OLED\n";
     return 0;
 }
-
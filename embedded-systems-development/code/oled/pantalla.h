@@ -0,0 +1,274 @@
+#ifndef PANTALLA_H
+#define PANTALLA_H
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifndef FB_PATH
+#define FB_PATH "/dev/fb1"
+#endif
+#ifndef PAQUETE_IMAGENES
+#define PAQUETE_IMAGENES "imagenes.pak"
+#endif
+#define WIDTH 128
+#define HEIGHT 64
+#define FB_SIZE (WIDTH * HEIGHT / 8)
+#define BYTES_FILA (WIDTH / 8)
+
+// El framebuffer se envía en páginas de 8 filas (128 bytes)
+#define NUM_PAGINAS (HEIGHT / 8)
+#define BYTES_PAGINA (BYTES_FILA * 8)
+#define TODAS_LAS_PAGINAS 0xFF
+
+// La pantalla está montada vertical: el usuario la ve de 64 x 128. La columna c
+// y la fila r que se ven corresponden al pixel x = 127 - r, y = 63 - c del
+// framebuffer, que guarda cada fila de 128 pixeles en 16 bytes, bit menos
+// significativo primero.
+#define ANCHO_VISIBLE HEIGHT
+#define ALTO_VISIBLE WIDTH
+
+#define INTERVALO_MINIMO_MS 33
+
+enum IdPantalla {
+    MENU_NORMAL, MENU_TUTOR, PANTALLA_NORMAL,
+    T_ESTRELLITA, T_HBD, T_PIRATAS, T_POLLITOS,
+    NUM_PANTALLAS
+};
+
+// Nombre de cada pantalla dentro del paquete (el nombre del PNG en o_images)
+const char* const nombresPantallas[NUM_PANTALLAS] = {
+    "menu_normal", "menu_tutor", "normal",
+    "tutor_estrellita", "tutor_cumpleaños", "tutor_piratasdelcaribe", "tutor_lospollitos"
+};
+
+// Abre el framebuffer una sola vez y tiene el paquete de imágenes (generado con
+// empaquetar_imagenes.py) cargado en memoria; mostrar una pantalla es
+// descomprimirla directo sobre la sombra. Se dibuja sobre esa copia y solo se
+// envían las páginas que cambiaron respecto a lo que ya tiene el panel, con un
+// ritmo máximo de envío para juntar actualizaciones seguidas.
+class Pantalla {
+public:
+    // Sin paquete se usa PAQUETE_IMAGENES (ver rutaPaquete)
+    bool abrir(const char* ruta = FB_PATH, const char* paquete = nullptr) {
+        std::string rutaImagenes = paquete ? paquete : rutaPaquete();
+        if (!cargarPaquete(rutaImagenes.c_str())) {
+            fprintf(stderr, "No se pudo cargar el paquete de imágenes %s\n", rutaImagenes.c_str());
+            return false;
+        }
+
+        fb = open(ruta, O_RDWR);
+        if (fb < 0) {
+            perror("No se pudo abrir el framebuffer");
+            return false;
+        }
+
+        // Lo que ya muestra el panel es el punto de partida de la sombra
+        if (pread(fb, panel, FB_SIZE, 0) != FB_SIZE) memset(panel, 0, FB_SIZE);
+        memcpy(sombra, panel, FB_SIZE);
+        sucias = 0;
+        ultimoEnvio = 0;
+        return true;
+    }
+
+    // Índice de una pantalla en el paquete, -1 si no está
+    int buscar(const std::string& nombre) const {
+        for (size_t i = 0; i < indice.size(); ++i)
+            if (indice[i].nombre == nombre) return int(i);
+        return -1;
+    }
+
+    bool mostrar(IdPantalla id) {
+        if (id < 0 || id >= NUM_PANTALLAS) return false;
+        return mostrar(nombresPantallas[id]);
+    }
+
+    // Cambia toda la pantalla y la envía de inmediato
+    bool mostrar(const std::string& nombre) {
+        int i = buscar(nombre);
+        if (fb < 0 || i < 0 || !descomprimir(indice[i], sombra)) return false;
+        sucias = TODAS_LAS_PAGINAS;
+        return enviar(true);
+    }
+
+    void limpiar() {
+        memset(sombra, 0, FB_SIZE);
+        sucias = TODAS_LAS_PAGINAS;
+    }
+
+    // Coordenadas visibles (c de 0 a 63, r de 0 a 127)
+    void pixel(int c, int r, bool encendido) {
+        if (c < 0 || c >= ANCHO_VISIBLE || r < 0 || r >= ALTO_VISIBLE) return;
+        int x = WIDTH - 1 - r;
+        int y = HEIGHT - 1 - c;
+        uint8_t& b = sombra[y * BYTES_FILA + x / 8];
+        uint8_t bit = uint8_t(1 << (x % 8));
+        b = encendido ? (b | bit) : (b & ~bit);
+        sucias |= uint8_t(1 << (y / 8));
+    }
+
+    void rectangulo(int c, int r, int ancho, int alto, bool encendido) {
+        for (int i = c; i < c + ancho; ++i)
+            for (int j = r; j < r + alto; ++j)
+                pixel(i, j, encendido);
+    }
+
+    // Acceso directo a la sombra para dibujar por bytes; quien escribe marca las filas
+    uint8_t* datos() { return sombra; }
+    void marcarFilas(int y0, int y1) {
+        for (int p = y0 / 8; p <= y1 / 8 && p < NUM_PAGINAS; ++p)
+            sucias |= uint8_t(1 << p);
+    }
+
+    // Envía lo pendiente si ya pasó el intervalo mínimo; si no, queda para la próxima llamada
+    bool actualizar() {
+        if (!sucias) return true;
+        if (ahoraMs() - ultimoEnvio < intervaloMs) return true;
+        return enviar(false);
+    }
+
+    // Escribe con pwrite solo las páginas sucias que de verdad cambiaron,
+    // juntando las páginas seguidas en una sola escritura
+    bool enviar(bool forzar) {
+        if (fb < 0) return false;
+        timespec t0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        uint64_t escriturasAntes = escrituras;
+        bool ok = true;
+        int p = 0;
+        while (p < NUM_PAGINAS) {
+            if (!paginaCambio(p, forzar)) {
+                ++p;
+                continue;
+            }
+            int inicio = p;
+            while (p < NUM_PAGINAS && paginaCambio(p, forzar)) ++p;
+
+            size_t offset = size_t(inicio) * BYTES_PAGINA;
+            size_t largo = size_t(p - inicio) * BYTES_PAGINA;
+            if (pwrite(fb, sombra + offset, largo, off_t(offset)) != ssize_t(largo)) ok = false;
+            memcpy(panel + offset, sombra + offset, largo);
+            bytesEnviados += largo;
+            ++escrituras;
+        }
+        sucias = 0;
+        ultimoEnvio = ahoraMs();
+        if (avisoEnvio && escrituras != escriturasAntes) {
+            timespec t1;
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            avisoEnvio(uint64_t((t1.tv_sec - t0.tv_sec) * 1000000000ll + (t1.tv_nsec - t0.tv_nsec)));
+        }
+        return ok;
+    }
+
+    void fijarIntervalo(long ms) { intervaloMs = ms; }
+
+    // Se llama con lo que tardó cada envío que escribió algo, en ns
+    typedef void (*AvisoEnvio)(uint64_t ns);
+    void alEnviar(AvisoEnvio aviso) { avisoEnvio = aviso; }
+    bool pendiente() const { return sucias != 0; }
+
+    void cerrar() {
+        if (fb >= 0) close(fb);
+        fb = -1;
+    }
+
+    // Estadísticas de lo enviado al panel
+    uint64_t bytesEnviados = 0;
+    uint64_t escrituras = 0;
+
+private:
+    struct Entrada {
+        std::string nombre;
+        uint32_t offset;
+        uint32_t largo;
+    };
+
+    int fb = -1;
+    std::vector<uint8_t> paquete;
+    std::vector<Entrada> indice;
+    uint8_t sombra[FB_SIZE];
+    uint8_t panel[FB_SIZE];
+    uint8_t sucias = 0;
+    long intervaloMs = INTERVALO_MINIMO_MS;
+    long ultimoEnvio = 0;
+    AvisoEnvio avisoEnvio = nullptr;
+
+    // PAQUETE_IMAGENES relativo es al lado del ejecutable, no del directorio
+    // actual: main_menu arranca desde init con cualquier directorio
+    static std::string rutaPaquete() {
+        if (PAQUETE_IMAGENES[0] == '/') return PAQUETE_IMAGENES;
+        char exe[4096];
+        ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+        if (n <= 0) return PAQUETE_IMAGENES;
+        std::string ruta(exe, size_t(n));
+        return ruta.substr(0, ruta.rfind('/') + 1) + PAQUETE_IMAGENES;
+    }
+
+    bool paginaCambio(int p, bool forzar) const {
+        if (!(sucias & (1 << p))) return false;
+        if (forzar) return true;
+        return memcmp(sombra + p * BYTES_PAGINA, panel + p * BYTES_PAGINA, BYTES_PAGINA) != 0;
+    }
+
+    static uint16_t leer16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+    static uint32_t leer32(const uint8_t* p) { return uint32_t(p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24)); }
+
+    bool cargarPaquete(const char* ruta) {
+        int f = open(ruta, O_RDONLY);
+        if (f < 0) return false;
+        off_t tam = lseek(f, 0, SEEK_END);
+        paquete.resize(tam > 0 ? size_t(tam) : 0);
+        bool ok = tam >= 8 && pread(f, paquete.data(), paquete.size(), 0) == ssize_t(paquete.size());
+        close(f);
+        if (!ok || memcmp(paquete.data(), "OLED", 4) != 0) return false;
+
+        uint16_t n = leer16(&paquete[6]);
+        indice.clear();
+        for (uint16_t i = 0; i < n; ++i) {
+            size_t p = 8 + size_t(i) * 32;
+            if (p + 32 > paquete.size()) return false;
+            const char* nombre = reinterpret_cast<const char*>(&paquete[p]);
+            Entrada e{std::string(nombre, strnlen(nombre, 24)), leer32(&paquete[p + 24]), leer32(&paquete[p + 28])};
+            if (size_t(e.offset) + e.largo > paquete.size()) return false;
+            indice.push_back(e);
+        }
+        return true;
+    }
+
+    // PackBits: 0..127 = copiar n+1 bytes, 128..255 = repetir el siguiente byte n-125 veces
+    bool descomprimir(const Entrada& e, uint8_t* destino) const {
+        const uint8_t* p = paquete.data() + e.offset;
+        const uint8_t* fin = p + e.largo;
+        size_t n = 0;
+        while (p < fin && n < FB_SIZE) {
+            uint8_t control = *p++;
+            if (control < 128) {
+                size_t largo = control + 1;
+                if (p + largo > fin || n + largo > FB_SIZE) return false;
+                memcpy(destino + n, p, largo);
+                p += largo;
+                n += largo;
+            } else {
+                size_t largo = control - 125;
+                if (p >= fin || n + largo > FB_SIZE) return false;
+                memset(destino + n, *p++, largo);
+                n += largo;
+            }
+        }
+        return n == FB_SIZE;
+    }
+
+    static long ahoraMs() {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec * 1000 + t.tv_nsec / 1000000;
+    }
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef VISUALIZACION_H
+#define VISUALIZACION_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include "pantalla.h"
+
+// Pantalla en vivo mientras se toca, en coordenadas visibles (64 x 128):
+//   filas 0-7    medidor de nivel con marca de pico
+//   filas 10-17  teclas presionadas, una columna de 2 pixeles por tecla (C4 a C6)
+//   filas 20-127 piano roll: la fila de arriba es el cuadro actual y las
+//                anteriores bajan una fila por cuadro
+// El audio y el escaneo solo publican su estado en atómicos; todo el dibujo y
+// el envío al panel ocurren en un hilo propio con prioridad baja.
+
+#define FPS_VISUALIZACION 30
+#define TECLAS_VISUALES 25
+#define ANCHO_TECLA 2
+#define C_TECLAS ((ANCHO_VISIBLE - TECLAS_VISUALES * ANCHO_TECLA) / 2)
+#define R_NIVEL 0
+#define ALTO_NIVEL 6
+#define R_TECLAS 10
+#define ALTO_TECLAS 8
+#define R_ROLL 20
+#define FILAS_ROLL (ALTO_VISIBLE - R_ROLL)
+#define DB_MINIMO -48.0f
+#define CAIDA_PICO 1      // columnas que baja la marca de pico por cuadro
+#define NICE_VISUALIZACION 10
+
+// Pico absoluto de un bloque de audio, para publicarlo como nivel
+inline int nivelPico(const int16_t* muestras, int frames) {
+    int pico = 0;
+    for (int i = 0; i < frames; ++i) {
+        int v = muestras[i] < 0 ? -muestras[i] : muestras[i];
+        if (v > pico) pico = v;
+    }
+    return pico;
+}
+
+// Lo que cuesta cada cuadro, para ajustar los cuadros por segundo
+struct EstadisticasVisualizacion {
+    uint64_t cuadros = 0;
+    uint64_t cuadrosPerdidos = 0;   // el hilo llegó tarde y se saltó el turno
+    uint64_t cuadrosEnviados = 0;   // cuadros que escribieron algo al panel
+    double cpuDibujoUs = 0;         // CPU del hilo dibujando, total
+    double peorDibujoUs = 0;
+    double envioUs = 0;             // tiempo de pared en pwrite, total
+    double peorEnvioUs = 0;
+    uint64_t bytes = 0;             // bytes enviados al panel, total
+};
+
+class Visualizacion {
+public:
+    // Se llaman desde el hilo de audio o de escaneo; no bloquean
+    void publicarTeclas(uint32_t mascara) { teclas.store(mascara, std::memory_order_relaxed); }
+    void publicarNivel(int pico) {
+        // Se guarda el mayor desde el último cuadro para no perder golpes cortos
+        int actual = nivel.load(std::memory_order_relaxed);
+        while (pico > actual && !nivel.compare_exchange_weak(actual, pico, std::memory_order_relaxed)) {}
+    }
+
+    // Toma la pantalla (nadie más debe dibujar en ella hasta detener())
+    void iniciar(Pantalla& p, int fps = FPS_VISUALIZACION) {
+        pantalla = &p;
+        periodoNs = 1000000000L / (fps > 0 ? fps : FPS_VISUALIZACION);
+        for (auto& f : historia) f = 0;
+        cabeza = 0;
+        columnaPico = 0;
+        stats = EstadisticasVisualizacion{};
+        pantalla->limpiar();
+        dibujarFijo();
+        corriendo = true;
+        hilo = std::thread(&Visualizacion::bucle, this);
+    }
+
+    void detener() {
+        if (!corriendo) return;
+        corriendo = false;
+        hilo.join();
+    }
+
+    // Leerlas después de detener()
+    const EstadisticasVisualizacion& estadisticas() const { return stats; }
+
+    void imprimirEstadisticas(FILE* salida = stdout) const {
+        if (!stats.cuadros) return;
+        double n = double(stats.cuadros);
+        fprintf(salida, "Visualización: %llu cuadros, %llu perdidos, %llu con envío\n",
+                (unsigned long long)stats.cuadros, (unsigned long long)stats.cuadrosPerdidos,
+                (unsigned long long)stats.cuadrosEnviados);
+        fprintf(salida, "  dibujo: %.1f us CPU promedio, peor %.1f us\n", stats.cpuDibujoUs / n, stats.peorDibujoUs);
+        fprintf(salida, "  envío:  %.1f us promedio, peor %.1f us, %.1f bytes por cuadro\n",
+                stats.envioUs / n, stats.peorEnvioUs, stats.bytes / n);
+    }
+
+private:
+    Pantalla* pantalla = nullptr;
+    std::thread hilo;
+    std::atomic<bool> corriendo{false};
+    std::atomic<uint32_t> teclas{0};
+    std::atomic<int> nivel{0};
+    long periodoNs = 1000000000L / FPS_VISUALIZACION;
+
+    uint32_t historia[FILAS_ROLL];  // anillo, una máscara de teclas por cuadro
+    int cabeza = 0;                 // posición del cuadro más nuevo
+    int columnaPico = 0;
+    EstadisticasVisualizacion stats;
+
+    static double us(const timespec& a, const timespec& b) {
+        return (b.tv_sec - a.tv_sec) * 1e6 + (b.tv_nsec - a.tv_nsec) / 1e3;
+    }
+
+    void bucle() {
+        // Por debajo del audio y del escaneo: si falta CPU, se pierden cuadros.
+        // El hilo hereda SCHED_FIFO si lo crea el bucle principal, así que se baja a mano.
+        sched_param normal{};
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+        setpriority(PRIO_PROCESS, pid_t(syscall(SYS_gettid)), NICE_VISUALIZACION);
+
+        timespec siguiente;
+        clock_gettime(CLOCK_MONOTONIC, &siguiente);
+        while (corriendo) {
+            siguiente.tv_nsec += periodoNs;
+            while (siguiente.tv_nsec >= 1000000000L) {
+                siguiente.tv_nsec -= 1000000000L;
+                ++siguiente.tv_sec;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &siguiente, nullptr);
+
+            timespec c0, c1, t0, t1;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &c0);
+            dibujarCuadro();
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &c1);
+
+            uint64_t antes = pantalla->bytesEnviados;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            pantalla->enviar(false);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+
+            double dibujo = us(c0, c1), envio = us(t0, t1);
+            uint64_t bytes = pantalla->bytesEnviados - antes;
+            ++stats.cuadros;
+            stats.cpuDibujoUs += dibujo;
+            stats.envioUs += envio;
+            stats.bytes += bytes;
+            if (bytes) ++stats.cuadrosEnviados;
+            if (dibujo > stats.peorDibujoUs) stats.peorDibujoUs = dibujo;
+            if (envio > stats.peorEnvioUs) stats.peorEnvioUs = envio;
+
+            // Si el cuadro se pasó de su turno no se intenta recuperar: se
+            // salta al siguiente turno libre
+            timespec ahora;
+            clock_gettime(CLOCK_MONOTONIC, &ahora);
+            while (us(siguiente, ahora) > periodoNs / 1000.0) {
+                siguiente.tv_nsec += periodoNs;
+                while (siguiente.tv_nsec >= 1000000000L) {
+                    siguiente.tv_nsec -= 1000000000L;
+                    ++siguiente.tv_sec;
+                }
+                ++stats.cuadrosPerdidos;
+            }
+        }
+    }
+
+    // Marco de la zona de teclas, que no cambia
+    void dibujarFijo() {
+        pantalla->rectangulo(C_TECLAS - 1, R_TECLAS + ALTO_TECLAS, TECLAS_VISUALES * ANCHO_TECLA + 2, 1, true);
+        pantalla->rectangulo(0, R_NIVEL + ALTO_NIVEL + 1, ANCHO_VISIBLE, 1, true);
+    }
+
+    void dibujarCuadro() {
+        uint32_t mascara = teclas.load(std::memory_order_relaxed);
+        int pico = nivel.exchange(0, std::memory_order_relaxed);
+
+        cabeza = (cabeza + FILAS_ROLL - 1) % FILAS_ROLL;
+        historia[cabeza] = mascara;
+
+        dibujarNivel(pico);
+        dibujarTeclas(mascara);
+        dibujarRoll();
+    }
+
+    void dibujarNivel(int pico) {
+        int columnas = 0;
+        if (pico > 0) {
+            float db = 20.0f * std::log10(pico / 32767.0f);
+            float t = (db - DB_MINIMO) / -DB_MINIMO;
+            if (t > 0) columnas = int(t * ANCHO_VISIBLE + 0.5f);
+            if (columnas > ANCHO_VISIBLE) columnas = ANCHO_VISIBLE;
+        }
+        columnaPico = columnas >= columnaPico ? columnas : columnaPico - CAIDA_PICO;
+        if (columnaPico < 0) columnaPico = 0;
+
+        pantalla->rectangulo(0, R_NIVEL, ANCHO_VISIBLE, ALTO_NIVEL, false);
+        pantalla->rectangulo(0, R_NIVEL + 1, columnas, ALTO_NIVEL - 2, true);
+        if (columnaPico > 0) pantalla->rectangulo(columnaPico - 1, R_NIVEL, 1, ALTO_NIVEL, true);
+    }
+
+    void dibujarTeclas(uint32_t mascara) {
+        for (int k = 0; k < TECLAS_VISUALES; ++k)
+            pantalla->rectangulo(C_TECLAS + k * ANCHO_TECLA, R_TECLAS, ANCHO_TECLA, ALTO_TECLAS, mascara & (1u << k));
+    }
+
+    // Cada tecla es una fila del framebuffer: se arma esa fila de bits
+    // completa (x = 127 - r) y se copian los bytes del roll de una vez
+    void dibujarRoll() {
+        uint8_t* sombra = pantalla->datos();
+        for (int k = 0; k < TECLAS_VISUALES; ++k) {
+            uint8_t fila[BYTES_FILA] = {};
+            for (int j = 0; j < FILAS_ROLL; ++j) {
+                if (!(historia[(cabeza + j) % FILAS_ROLL] & (1u << k))) continue;
+                int x = WIDTH - 1 - (R_ROLL + j);
+                fila[x / 8] |= uint8_t(1 << (x % 8));
+            }
+            // El roll ocupa x de 0 a 127 - R_ROLL, los bytes completos más uno partido
+            int bytesRoll = (WIDTH - R_ROLL) / 8;
+            uint8_t mascaraParcial = uint8_t((1 << ((WIDTH - R_ROLL) % 8)) - 1);
+            for (int i = 0; i < ANCHO_TECLA; ++i) {
+                int c = C_TECLAS + k * ANCHO_TECLA + i;
+                uint8_t* destino = sombra + (HEIGHT - 1 - c) * BYTES_FILA;
+                memcpy(destino, fila, bytesRoll);
+                if (mascaraParcial)
+                    destino[bytesRoll] = uint8_t((destino[bytesRoll] & ~mascaraParcial) | (fila[bytesRoll] & mascaraParcial));
+            }
+        }
+        pantalla->marcarFilas(HEIGHT - C_TECLAS - TECLAS_VISUALES * ANCHO_TECLA, HEIGHT - 1 - C_TECLAS);
+    }
+};
+
+#endif
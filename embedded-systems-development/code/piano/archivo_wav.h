@@ -0,0 +1,68 @@
+#ifndef ARCHIVO_WAV_H
+#define ARCHIVO_WAV_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// WAV PCM S16 (el mismo formato que sale por ALSA). El encabezado se escribe
+// al abrir con tamaños en cero y se completa al cerrar.
+class EscritorWav {
+public:
+    bool abrir(const std::string& ruta, uint32_t tasa, uint16_t canales = 1) {
+        archivo = fopen(ruta.c_str(), "wb");
+        if (!archivo) return false;
+        this->tasa = tasa;
+        this->canales = canales;
+        muestras = 0;
+        return escribirEncabezado();
+    }
+
+    bool escribir(const int16_t* datos, size_t n) {
+        if (!archivo || fwrite(datos, sizeof(int16_t), n, archivo) != n) return false;
+        muestras += n;
+        return true;
+    }
+
+    bool cerrar() {
+        if (!archivo) return false;
+        bool ok = fseek(archivo, 0, SEEK_SET) == 0 && escribirEncabezado();
+        ok = fclose(archivo) == 0 && ok;
+        archivo = nullptr;
+        return ok;
+    }
+
+    ~EscritorWav() {
+        if (archivo) cerrar();
+    }
+
+private:
+    FILE* archivo = nullptr;
+    uint32_t tasa = 0;
+    uint16_t canales = 1;
+    uint64_t muestras = 0;
+
+    static void poner16(uint8_t* p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+    static void poner32(uint8_t* p, uint32_t v) { poner16(p, uint16_t(v)); poner16(p + 2, uint16_t(v >> 16)); }
+
+    bool escribirEncabezado() {
+        uint32_t datos = uint32_t(muestras * sizeof(int16_t));
+        uint8_t h[44];
+        memcpy(h, "RIFF", 4);
+        poner32(h + 4, 36 + datos);
+        memcpy(h + 8, "WAVEfmt ", 8);
+        poner32(h + 16, 16);
+        poner16(h + 20, 1);                          // PCM
+        poner16(h + 22, canales);
+        poner32(h + 24, tasa);
+        poner32(h + 28, tasa * canales * 2);         // bytes por segundo
+        poner16(h + 32, uint16_t(canales * 2));      // bytes por cuadro
+        poner16(h + 34, 16);
+        memcpy(h + 36, "data", 4);
+        poner32(h + 40, datos);
+        return fwrite(h, 1, sizeof(h), archivo) == sizeof(h);
+    }
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef CAPTURA_H
+#define CAPTURA_H
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "cola_eventos.h"
+#include "sintetizador.h"
+#include "linea_tiempo.h"
+
+// Captura de lo que leyó cada escaneo de la matriz, para volver a pasarlo
+// tal cual (main_menu --capturar, renderizar --captura, y el simulador de
+// GPIO con la acción "captura" del guion).
+//
+// Archivo binario, enteros en little endian:
+//   "TECLAS01"                      8 bytes
+//   ns del primer escaneo           uint64 (CLOCK_MONOTONIC)
+//   por escaneo, 8 bytes:           uint32 us desde el escaneo anterior
+//                                   uint32 teclas (bit n = nota n)
+// Son 1.6 KB por segundo escaneando cada 5 ms.
+//
+// El escaneo solo pone la muestra en un anillo; un hilo de baja prioridad la
+// escribe cada INTERVALO_CAPTURA_MS. Si el anillo se llena se descarta y se
+// cuenta, como en el registro.
+
+#define MAGIA_CAPTURA "TECLAS01"
+#define TAM_ANILLO_CAPTURA 1024
+#define INTERVALO_CAPTURA_MS 100
+#define NICE_CAPTURA 19
+
+struct MuestraEscaneo {
+    uint64_t ns;
+    uint32_t teclas;
+};
+
+inline void ponerLe(uint8_t* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) p[i] = uint8_t(v >> (8 * i));
+}
+
+inline uint64_t leerLe(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = v << 8 | p[i];
+    return v;
+}
+
+class CapturaTeclado {
+public:
+    bool abrir(const char* ruta) {
+        archivo = fopen(ruta, "wb");
+        if (!archivo) {
+            perror("No se pudo abrir el archivo de captura");
+            return false;
+        }
+        anterior = 0;
+        escritas = 0;
+        corriendo = true;
+        hilo = std::thread(&CapturaTeclado::bucle, this);
+        return true;
+    }
+
+    // Desde el hilo que escanea; nunca bloquea
+    void registrar(uint64_t ns, uint32_t teclas) {
+        if (!corriendo.load(std::memory_order_relaxed)) return;
+        if (!cola.poner({ns, teclas})) descartadas.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void cerrar() {
+        if (!corriendo) return;
+        corriendo = false;
+        hilo.join();
+        fclose(archivo);
+        archivo = nullptr;
+    }
+
+    bool activa() const { return corriendo.load(std::memory_order_relaxed); }
+    uint64_t escaneos() const { return escritas; }
+    uint64_t escaneosDescartados() const { return descartadas.load(std::memory_order_relaxed); }
+
+private:
+    ColaEventos<MuestraEscaneo, TAM_ANILLO_CAPTURA> cola;
+    std::atomic<bool> corriendo{false};
+    std::atomic<uint64_t> descartadas{0};
+    std::thread hilo;
+    FILE* archivo = nullptr;
+    uint64_t anterior = 0;
+    uint64_t escritas = 0;
+
+    void bucle() {
+        sched_param normal{};
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+        setpriority(PRIO_PROCESS, pid_t(syscall(SYS_gettid)), NICE_CAPTURA);
+
+        bool seguir = true;
+        while (seguir) {
+            seguir = corriendo;
+            if (seguir) usleep(INTERVALO_CAPTURA_MS * 1000);
+            const MuestraEscaneo* m;
+            while ((m = cola.frente())) {
+                escribir(*m);
+                cola.sacar();
+            }
+            fflush(archivo);
+        }
+    }
+
+    void escribir(const MuestraEscaneo& m) {
+        uint8_t r[16];
+        if (!escritas) {
+            memcpy(r, MAGIA_CAPTURA, 8);
+            ponerLe(r + 8, m.ns, 8);
+            fwrite(r, 1, 16, archivo);
+            anterior = m.ns;
+        }
+        uint64_t us = m.ns > anterior ? (m.ns - anterior) / 1000 : 0;
+        ponerLe(r, us > UINT32_MAX ? UINT32_MAX : us, 4);
+        ponerLe(r + 4, m.teclas, 4);
+        fwrite(r, 1, 8, archivo);
+        // Se acumula en microsegundos para que el redondeo no se arrastre
+        anterior += us * 1000;
+        ++escritas;
+    }
+};
+
+// Lee una captura entera; false si no existe o no es una captura
+inline bool leerCaptura(const char* ruta, std::vector<MuestraEscaneo>& muestras) {
+    FILE* f = fopen(ruta, "rb");
+    if (!f) return false;
+    uint8_t r[16];
+    if (fread(r, 1, 16, f) != 16 || memcmp(r, MAGIA_CAPTURA, 8)) {
+        fclose(f);
+        return false;
+    }
+    uint64_t ns = leerLe(r + 8, 8);
+    muestras.clear();
+    while (fread(r, 1, 8, f) == 8) {
+        ns += leerLe(r, 4) * 1000;
+        muestras.push_back({ns, uint32_t(leerLe(r + 4, 4))});
+    }
+    fclose(f);
+    return true;
+}
+
+// Pasa una captura a eventos de nota igual que escanearYTocar: cada tecla
+// que cambió entre dos escaneos, en la muestra que corresponde al tiempo del
+// escaneo, con el primero a "inicio" muestras. Las que quedaron apretadas se
+// sueltan medio segundo después del último. Devuelve cuántas notas se
+// tocaron, -1 si no se pudo leer.
+inline int lineaDeCaptura(const char* ruta, LineaTiempo& linea, uint64_t inicio = FRECUENCIA_MUESTREO / 2) {
+    std::vector<MuestraEscaneo> muestras;
+    if (!leerCaptura(ruta, muestras)) return -1;
+    if (muestras.empty()) return 0;
+    uint64_t primero = muestras.front().ns;
+    auto muestra = [&](uint64_t ns) { return inicio + (ns - primero) * FRECUENCIA_MUESTREO / 1000000000ull; };
+
+    uint32_t antes = 0;
+    int notas = 0;
+    for (const auto& m : muestras) {
+        uint32_t cambios = m.teclas ^ antes;
+        for (int n = 0; n < NUM_NOTAS; ++n) {
+            if (!(cambios & (1u << n))) continue;
+            bool encender = m.teclas & (1u << n);
+            linea.agregar(muestra(m.ns), n, encender);
+            notas += encender;
+        }
+        antes = m.teclas;
+    }
+    for (int n = 0; n < NUM_NOTAS; ++n)
+        if (antes & (1u << n)) linea.agregar(muestra(muestras.back().ns) + FRECUENCIA_MUESTREO / 2, n, false);
+    linea.ordenar();
+    return notas;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef CARGA_AUDIO_H
+#define CARGA_AUDIO_H
+
+#include <cstdint>
+
+// Control de carga del hilo de audio. Cada periodo se mide cuánto tardó el
+// render contra lo que dura el periodo (el plazo: si se pasa, ALSA se queda
+// sin muestras) y se lleva una media móvil. Con sobrecarga se baja un nivel
+// por vez, siempre en el mismo orden, y se vuelve atrás de a uno cuando la
+// carga se queda baja un buen rato:
+//   1. sin observador: no se alimenta el medidor de nivel de la pantalla
+//   2. síntesis desde el cache de bucles, la más barata por voz
+//   3. en adelante, VOCES_POR_PASO voces menos cada vez, hasta MIN_VOCES_CARGA
+// Solo cuenta y decide; MotorAudio aplica los niveles.
+
+#define CARGA_ALTA 800             // milésimas del periodo: con la media por encima se degrada
+#define CARGA_BAJA 500             // y por debajo se puede recuperar
+#define PESO_MEDIA_CARGA 8         // la media se acerca 1/8 a cada periodo
+#define PERIODOS_ENTRE_PASOS 16    // después de degradar, lo que se espera a que se note
+#define RECUPERAR_MS 2000          // con la media baja este tiempo se sube un nivel
+#define VOCES_POR_PASO 2
+#define MIN_VOCES_CARGA 4
+
+enum NivelCarga {
+    CARGA_NORMAL,
+    CARGA_SIN_OBSERVADOR,
+    CARGA_SINTESIS_CACHE,
+    CARGA_MENOS_VOCES       // y los que siguen, cada uno con menos voces
+};
+
+const char* const nombresNivelCarga[] = { "normal", "sin observador", "síntesis desde el cache", "menos voces" };
+
+inline const char* nombreNivelCarga(int nivel) {
+    return nivel < 0 ? "?" : nombresNivelCarga[nivel < CARGA_MENOS_VOCES ? nivel : CARGA_MENOS_VOCES];
+}
+
+// Voces que quedan en un nivel, con "polifonia" voces en total
+inline int vocesEnNivel(int nivel, int polifonia) {
+    if (nivel < CARGA_MENOS_VOCES) return polifonia;
+    int voces = polifonia - (nivel - CARGA_MENOS_VOCES + 1) * VOCES_POR_PASO;
+    return voces > MIN_VOCES_CARGA ? voces : (polifonia < MIN_VOCES_CARGA ? polifonia : MIN_VOCES_CARGA);
+}
+
+// El nivel más bajo al que se llega: el primero que ya no quita voces
+inline int nivelMaximoCarga(int polifonia) {
+    int nivel = CARGA_SINTESIS_CACHE;
+    while (vocesEnNivel(nivel + 1, polifonia) < vocesEnNivel(nivel, polifonia)) ++nivel;
+    return nivel;
+}
+
+class ControlCarga {
+public:
+    // periodoUs es lo que dura un periodo de audio
+    void iniciar(int nivelMaximo, double periodoUs) {
+        maximo = nivelMaximo;
+        periodosRecuperar = uint32_t(RECUPERAR_MS * 1000.0 / periodoUs) + 1;
+        nivelActual = CARGA_NORMAL;
+        media = 0;
+        espera = 0;
+        bajos = 0;
+    }
+
+    // Con la carga del último periodo en milésimas. Devuelve +1 si hay que
+    // bajar un nivel, -1 si se puede subir uno y 0 si se queda.
+    int observar(uint32_t carga) {
+        media += (float(carga) - media) / PESO_MEDIA_CARGA;
+        if (carga > pico) pico = carga;
+        if (carga >= 1000) ++tarde;
+        if (espera > 0) --espera;
+
+        // Un periodo que no llegó a tiempo no espera a la media
+        bool sobrecarga = media > CARGA_ALTA || carga >= 1000;
+        if (sobrecarga && espera == 0 && nivelActual < maximo) {
+            ++nivelActual;
+            ++degradaciones;
+            espera = PERIODOS_ENTRE_PASOS;
+            bajos = 0;
+            return 1;
+        }
+        bajos = media < CARGA_BAJA ? bajos + 1 : 0;
+        if (bajos >= periodosRecuperar && nivelActual > CARGA_NORMAL) {
+            --nivelActual;
+            ++recuperaciones;
+            bajos = 0;
+            return -1;
+        }
+        return 0;
+    }
+
+    int nivel() const { return nivelActual; }
+    uint32_t cargaMedia() const { return uint32_t(media); }
+    uint32_t cargaPico() const { return pico; }
+    uint64_t periodosTarde() const { return tarde; }
+    uint64_t vecesDegradado() const { return degradaciones; }
+    uint64_t vecesRecuperado() const { return recuperaciones; }
+
+private:
+    int maximo = CARGA_NORMAL;
+    int nivelActual = CARGA_NORMAL;
+    float media = 0;
+    uint32_t pico = 0;
+    uint32_t espera = 0;
+    uint32_t bajos = 0;
+    uint32_t periodosRecuperar = 1;
+    uint64_t tarde = 0;
+    uint64_t degradaciones = 0;
+    uint64_t recuperaciones = 0;
+};
+
+#endif
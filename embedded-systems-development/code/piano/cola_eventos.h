@@ -0,0 +1,41 @@
+#ifndef COLA_EVENTOS_H
+#define COLA_EVENTOS_H
+
+#include <atomic>
+#include <cstddef>
+
+// Cola circular de un productor y un consumidor sin bloqueos: el hilo que
+// escanea pone eventos y el hilo de audio los saca al empezar cada periodo.
+// N debe ser potencia de 2.
+template <typename T, size_t N>
+class ColaEventos {
+    static_assert((N & (N - 1)) == 0, "N debe ser potencia de 2");
+
+public:
+    // Devuelve false si la cola está llena (el evento se pierde)
+    bool poner(const T& e) {
+        size_t f = fin.load(std::memory_order_relaxed);
+        if (f - inicio.load(std::memory_order_acquire) == N) return false;
+        datos[f & (N - 1)] = e;
+        fin.store(f + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Primer evento sin sacarlo, nullptr si está vacía
+    const T* frente() const {
+        size_t i = inicio.load(std::memory_order_relaxed);
+        if (i == fin.load(std::memory_order_acquire)) return nullptr;
+        return &datos[i & (N - 1)];
+    }
+
+    void sacar() { inicio.store(inicio.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    bool vacia() const { return frente() == nullptr; }
+
+private:
+    T datos[N];
+    std::atomic<size_t> inicio{0};
+    std::atomic<size_t> fin{0};
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef LINEA_TIEMPO_H
+#define LINEA_TIEMPO_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include "sintetizador.h"
+
+// Evento programado en el reloj de muestras del motor de audio
+struct EventoNota {
+    uint64_t muestra;
+    int nota;
+    bool encender;
+};
+
+// Renderiza [inicio, inicio + frames) partiendo el periodo en cada evento para
+// aplicarlo en su muestra exacta. La fuente entrega con proximo() el siguiente
+// evento pendiente (nullptr si no hay más) y lo descarta con avanzar().
+template <typename Fuente>
+void renderConEventos(Sintetizador& sinte, Fuente& fuente, uint64_t inicio, int16_t* salida, int frames) {
+    uint64_t fin = inicio + frames;
+    int hecho = 0;
+    const EventoNota* e;
+    while ((e = fuente.proximo()) && e->muestra < fin) {
+        int offset = e->muestra > inicio ? int(e->muestra - inicio) : 0;
+        if (offset > hecho) {
+            sinte.render(salida + hecho, offset - hecho);
+            hecho = offset;
+        }
+        if (e->encender) sinte.notaOn(e->nota);
+        else sinte.notaOff(e->nota);
+        fuente.avanzar();
+    }
+    if (hecho < frames) sinte.render(salida + hecho, frames - hecho);
+}
+
+// Lista ordenada de eventos que se consume periodo a periodo. Cada evento
+// se aplica en la muestra exacta dentro del periodo, no con sleeps.
+class LineaTiempo {
+public:
+    void agregar(uint64_t muestra, int nota, bool encender) {
+        eventos.push_back({muestra, nota, encender});
+    }
+
+    // En la misma muestra los apagados van antes que los encendidos,
+    // así una nota repetida se vuelve a atacar
+    void ordenar() {
+        std::stable_sort(eventos.begin(), eventos.end(), [](const EventoNota& a, const EventoNota& b) {
+            if (a.muestra != b.muestra) return a.muestra < b.muestra;
+            return !a.encender && b.encender;
+        });
+        cursor = 0;
+    }
+
+    void renderPeriodo(Sintetizador& sinte, uint64_t inicio, int16_t* salida, int frames) {
+        renderConEventos(sinte, *this, inicio, salida, frames);
+    }
+
+    const EventoNota* proximo() const { return cursor < eventos.size() ? &eventos[cursor] : nullptr; }
+    void avanzar() { ++cursor; }
+
+    bool terminada() const { return cursor >= eventos.size(); }
+    uint64_t duracion() const { return eventos.empty() ? 0 : eventos.back().muestra; }
+    const std::vector<EventoNota>& lista() const { return eventos; }
+
+private:
+    std::vector<EventoNota> eventos;
+    size_t cursor = 0;
+};
+
+// Lee de un registro de texto (main_menu --registro) las notas tocadas y
+// las pone en una línea de tiempo, con la primera a "inicio" muestras. Las
+// demás líneas se ignoran. El archivo se abre para agregar, así que puede
+// traer varias sesiones: cuando el tiempo vuelve atrás la siguiente se pone
+// un segundo después. Las teclas que quedaron apretadas al terminar una
+// sesión se sueltan medio segundo después. Devuelve cuántas notas encontró.
+inline int lineaDeRegistro(const char* ruta, LineaTiempo& linea, uint64_t inicio = FRECUENCIA_MUESTREO / 2) {
+    FILE* f = fopen(ruta, "r");
+    if (!f) return -1;
+    char texto[256];
+    double primero = -1, desplazamiento = 0, ultimo = 0;
+    uint32_t apretadas = 0;
+    int notas = 0;
+
+    auto soltarTodas = [&]() {
+        uint64_t muestra = inicio + uint64_t((ultimo - primero + 0.5) * FRECUENCIA_MUESTREO);
+        for (int n = 0; n < NUM_NOTAS; ++n)
+            if (apretadas & (1u << n)) linea.agregar(muestra, n, false);
+        apretadas = 0;
+    };
+
+    while (fgets(texto, sizeof(texto), f)) {
+        double segundos;
+        unsigned hilo;
+        char nota[8];
+        bool encender;
+        if (sscanf(texto, "%lf [%u] Tocando: %7s", &segundos, &hilo, nota) == 3) encender = true;
+        else if (sscanf(texto, "%lf [%u] Nota parada: %7s", &segundos, &hilo, nota) == 3) encender = false;
+        else continue;
+        int n = indiceNota(nota);
+        if (n < 0) continue;
+
+        double t = segundos + desplazamiento;
+        if (primero < 0) {
+            primero = ultimo = t;
+        } else if (t < ultimo) {
+            soltarTodas();
+            desplazamiento += ultimo + 1.0 - t;
+            t = ultimo + 1.0;
+        }
+        ultimo = t;
+        linea.agregar(inicio + uint64_t((t - primero) * FRECUENCIA_MUESTREO + 0.5), n, encender);
+        apretadas = encender ? (apretadas | (1u << n)) : (apretadas & ~(1u << n));
+        notas += encender;
+    }
+    fclose(f);
+    soltarTodas();
+    linea.ordenar();
+    return notas;
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef MATRIZ_H
+#define MATRIZ_H
+
+#include <gpiod.h>
+#include <unistd.h>
+#include <cstdint>
+#include "pines.h"
+
+// Pausa entre flancos. Con el GPIO simulado (simulador/gpiod.h) la define
+// el simulador, que la cuenta en su reloj.
+#ifndef GPIO_SIMULADO
+inline void esperarGpio(unsigned int us) { usleep(us); }
+#endif
+
+// Teclas y LEDs del piano con las líneas pedidas una sola vez
+class Matriz {
+public:
+    bool abrir(const char* consumidor) {
+        chip = gpiod_chip_open_by_name(CHIPNAME);
+        if (!chip) return false;
+
+        serOut = gpiod_chip_get_line(chip, PIN_SER_OUT);
+        clkOut = gpiod_chip_get_line(chip, PIN_CLK_OUT);
+        latchOut = gpiod_chip_get_line(chip, PIN_LATCH_OUT);
+        serIn = gpiod_chip_get_line(chip, PIN_SER_IN);
+        clkIn = gpiod_chip_get_line(chip, PIN_CLK_IN);
+        latchIn = gpiod_chip_get_line(chip, PIN_LATCH_IN);
+        serCol = gpiod_chip_get_line(chip, PIN_SER_COL);
+        clkCol = gpiod_chip_get_line(chip, PIN_CLK_COL);
+        latchCol = gpiod_chip_get_line(chip, PIN_LATCH_COL);
+        serRow = gpiod_chip_get_line(chip, PIN_SER_ROW);
+        clkRow = gpiod_chip_get_line(chip, PIN_CLK_ROW);
+        latchRow = gpiod_chip_get_line(chip, PIN_LATCH_ROW);
+
+        if (!serOut || !clkOut || !latchOut || !serIn || !clkIn || !latchIn ||
+            !serCol || !clkCol || !latchCol || !serRow || !clkRow || !latchRow)
+            return false;
+
+        if (gpiod_line_request_output(serOut, consumidor, 0) < 0 ||
+            gpiod_line_request_output(clkOut, consumidor, 0) < 0 ||
+            gpiod_line_request_output(latchOut, consumidor, 0) < 0 ||
+            gpiod_line_request_input(serIn, consumidor) < 0 ||
+            gpiod_line_request_output(clkIn, consumidor, 0) < 0 ||
+            gpiod_line_request_output(latchIn, consumidor, 0) < 0 ||
+            gpiod_line_request_output(serCol, consumidor, 0) < 0 ||
+            gpiod_line_request_output(clkCol, consumidor, 0) < 0 ||
+            gpiod_line_request_output(latchCol, consumidor, 0) < 0 ||
+            gpiod_line_request_output(serRow, consumidor, 0) < 0 ||
+            gpiod_line_request_output(clkRow, consumidor, 0) < 0 ||
+            gpiod_line_request_output(latchRow, consumidor, 0) < 0)
+            return false;
+
+        return true;
+    }
+
+    void cerrar() {
+        if (chip) gpiod_chip_close(chip);
+        chip = nullptr;
+    }
+
+    // Devuelve un bit por nota (bit 0 = C4) con las teclas presionadas
+    uint32_t escanear() {
+        uint32_t mascara = 0;
+        for (int col = 0; col < 5; ++col) {
+            shiftOut(serOut, clkOut, latchOut, 1 << col);
+            esperarGpio(100);
+            uint8_t rowState = shiftIn() >> 1;
+            for (int row = 0; row < 5; ++row)
+                if (rowState & (1 << row))
+                    mascara |= 1u << notaEnMatriz(col, row);
+        }
+        return mascara;
+    }
+
+    void encenderLed(int nota) {
+        if (nota < 0 || nota >= 25) return;
+        int col = nota % 5;
+        int row = nota / 5;
+        shiftOut(serCol, clkCol, latchCol, 1 << col);
+        shiftOut(serRow, clkRow, latchRow, ~(1 << row));  // lógica inversa
+    }
+
+    void apagarLeds() {
+        shiftOut(serCol, clkCol, latchCol, 0);
+        shiftOut(serRow, clkRow, latchRow, 0);
+    }
+
+protected:
+    // Protegido para que test_code/bench_micro.cpp mida el bus por separado
+    gpiod_chip* chip = nullptr;
+    gpiod_line *serOut, *clkOut, *latchOut;
+    gpiod_line *serIn, *clkIn, *latchIn;
+    gpiod_line *serCol, *clkCol, *latchCol;
+    gpiod_line *serRow, *clkRow, *latchRow;
+
+    void pulse(gpiod_line* line) {
+        gpiod_line_set_value(line, 1);
+        esperarGpio(1);
+        gpiod_line_set_value(line, 0);
+        esperarGpio(1);
+    }
+
+    void shiftOut(gpiod_line* data, gpiod_line* clk, gpiod_line* latch, uint8_t val) {
+        for (int i = 7; i >= 0; --i) {
+            gpiod_line_set_value(data, (val >> i) & 1);
+            pulse(clk);
+        }
+        pulse(latch);
+    }
+
+    uint8_t shiftIn() {
+        gpiod_line_set_value(latchIn, 0);
+        esperarGpio(1);
+        gpiod_line_set_value(latchIn, 1);
+        esperarGpio(1);
+
+        uint8_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            pulse(clkIn);
+            value = (value << 1) | (gpiod_line_get_value(serIn) & 1);
+        }
+        return value;
+    }
+};
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <initializer_list>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Métricas del piano mientras corre. Los caminos calientes solo suman a
+// contadores atómicos (relaxed, sin bloqueos ni llamadas al sistema); el
+// texto se arma recién cuando alguien lee, en el hilo del servidor, con
+// prioridad baja. Se sirven en formato de exposición de Prometheus por un
+// socket UNIX: piano/ver_metricas.cpp las muestra en la consola serie, y
+// quien mande "GET" recibe además la cabecera HTTP, para un exportador.
+//
+// Todos los valores son enteros; "escala" dice por cuánto dividir al
+// mostrarlos (1e9 para pasar de ns a segundos, 1000 para milésimas).
+
+#define RUTA_METRICAS "/run/piano-metricas.sock"
+#define MAX_METRICAS 32
+#define MAX_CUBETAS 10
+#define NICE_METRICAS 19
+#define ESPERA_PEDIDO_MS 50     // lo que se espera a que el cliente mande "GET"
+
+class Metrica;
+
+// Todas las métricas del programa, en el orden en que se crearon
+class Metricas {
+public:
+    static Metricas& global() {
+        static Metricas m;
+        return m;
+    }
+
+    void agregar(const Metrica* m) {
+        if (cantidad < MAX_METRICAS) lista[cantidad++] = m;
+    }
+
+    inline std::string texto() const;
+
+    // Sirve el texto a cada conexión en "ruta" hasta detener()
+    bool servir(const char* ruta = RUTA_METRICAS) {
+        sockaddr_un dir{};
+        dir.sun_family = AF_UNIX;
+        if (strlen(ruta) >= sizeof(dir.sun_path)) return false;
+        strcpy(dir.sun_path, ruta);
+        // Solo se borra un socket que quedó de otra vez, nunca otro archivo
+        struct stat st;
+        if (lstat(ruta, &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                fprintf(stderr, "%s ya existe y no es un socket\n", ruta);
+                return false;
+            }
+            unlink(ruta);
+        }
+        servidor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (servidor < 0 || bind(servidor, reinterpret_cast<sockaddr*>(&dir), sizeof(dir)) < 0 || listen(servidor, 4) < 0) {
+            perror("No se pudo abrir el socket de métricas");
+            if (servidor >= 0) close(servidor);
+            servidor = -1;
+            return false;
+        }
+        strcpy(rutaSocket, ruta);
+        corriendo = true;
+        hilo = std::thread(&Metricas::bucle, this);
+        return true;
+    }
+
+    void detener() {
+        if (!corriendo) return;
+        corriendo = false;
+        hilo.join();
+        close(servidor);
+        struct stat st;
+        if (lstat(rutaSocket, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(rutaSocket);
+        servidor = -1;
+    }
+
+private:
+    const Metrica* lista[MAX_METRICAS];
+    int cantidad = 0;
+    int servidor = -1;
+    char rutaSocket[sizeof(sockaddr_un::sun_path)] = "";
+    std::atomic<bool> corriendo{false};
+    std::thread hilo;
+
+    Metricas() = default;
+
+    void bucle() {
+        sched_param normal{};
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+        setpriority(PRIO_PROCESS, pid_t(syscall(SYS_gettid)), NICE_METRICAS);
+
+        while (corriendo) {
+            pollfd p{servidor, POLLIN, 0};
+            if (poll(&p, 1, 200) <= 0) continue;
+            int cliente = accept4(servidor, nullptr, nullptr, SOCK_CLOEXEC);
+            if (cliente < 0) continue;
+            responder(cliente);
+            close(cliente);
+        }
+    }
+
+    void responder(int cliente) {
+        // Sin pedido se manda solo el texto; con "GET" también la cabecera
+        char pedido[256];
+        pollfd p{cliente, POLLIN, 0};
+        ssize_t leidos = poll(&p, 1, ESPERA_PEDIDO_MS) > 0 ? read(cliente, pedido, sizeof(pedido)) : 0;
+        std::string cuerpo = texto();
+        std::string respuesta;
+        if (leidos >= 3 && !strncmp(pedido, "GET", 3)) {
+            respuesta = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                        std::to_string(cuerpo.size()) + "\r\n\r\n";
+        }
+        respuesta += cuerpo;
+        size_t enviado = 0;
+        while (enviado < respuesta.size()) {
+            ssize_t n = send(cliente, respuesta.data() + enviado, respuesta.size() - enviado, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            enviado += size_t(n);
+        }
+    }
+};
+
+class Metrica {
+public:
+    Metrica(const char* nombre, const char* ayuda, const char* tipo, double escala)
+        : nombre(nombre), ayuda(ayuda), tipo(tipo), escala(escala) {
+        Metricas::global().agregar(this);
+    }
+    Metrica(const Metrica&) = delete;
+    Metrica& operator=(const Metrica&) = delete;
+
+    void escribir(std::string& salida) const {
+        salida += std::string("# HELP ") + nombre + " " + ayuda + "\n# TYPE " + nombre + " " + tipo + "\n";
+        valores(salida);
+    }
+
+protected:
+    const char* nombre;
+    const char* ayuda;
+    const char* tipo;
+    double escala;
+
+    virtual void valores(std::string& salida) const = 0;
+
+    static std::string numero(double v) {
+        char texto[32];
+        snprintf(texto, sizeof(texto), "%.9g", v);
+        return texto;
+    }
+};
+
+inline std::string Metricas::texto() const {
+    std::string salida;
+    for (int i = 0; i < cantidad; ++i) lista[i]->escribir(salida);
+    return salida;
+}
+
+// Solo sube; fijar() es para copiar un total que ya cuenta otro (xruns)
+class Contador : public Metrica {
+public:
+    Contador(const char* nombre, const char* ayuda, double escala = 1) : Metrica(nombre, ayuda, "counter", escala) {}
+    void sumar(uint64_t n = 1) { valor.fetch_add(n, std::memory_order_relaxed); }
+    void fijar(uint64_t total) { valor.store(total, std::memory_order_relaxed); }
+    uint64_t leer() const { return valor.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> valor{0};
+    void valores(std::string& salida) const override { salida += std::string(nombre) + " " + numero(double(leer()) / escala) + "\n"; }
+};
+
+// Un valor que sube y baja (voces sonando)
+class Medidor : public Metrica {
+public:
+    Medidor(const char* nombre, const char* ayuda, double escala = 1) : Metrica(nombre, ayuda, "gauge", escala) {}
+    void fijar(int64_t v) { valor.store(v, std::memory_order_relaxed); }
+    int64_t leer() const { return valor.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> valor{0};
+    void valores(std::string& salida) const override { salida += std::string(nombre) + " " + numero(double(leer()) / escala) + "\n"; }
+};
+
+// Cubetas fijas (límites superiores, en la unidad de observar()) más la de
+// "+Inf". Cada observación es una búsqueda en a lo sumo MAX_CUBETAS límites y
+// tres sumas atómicas; se puede observar desde varios hilos. Quien lee puede
+// ver una observación a medias (la cubeta sí y la suma todavía no), lo mismo
+// que con cualquier scrape.
+class Histograma : public Metrica {
+public:
+    Histograma(const char* nombre, const char* ayuda, std::initializer_list<uint64_t> limites, double escala = 1)
+        : Metrica(nombre, ayuda, "histogram", escala) {
+        for (uint64_t l : limites)
+            if (numLimites < MAX_CUBETAS) this->limites[numLimites++] = l;
+    }
+
+    void observar(uint64_t v) {
+        int c = 0;
+        while (c < numLimites && v > limites[c]) ++c;
+        cubetas[c].fetch_add(1, std::memory_order_relaxed);
+        suma.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    uint64_t cantidad() const {
+        uint64_t total = 0;
+        for (int c = 0; c <= numLimites; ++c) total += cubetas[c].load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    uint64_t limites[MAX_CUBETAS];
+    int numLimites = 0;
+    std::atomic<uint64_t> cubetas[MAX_CUBETAS + 1] = {};
+    std::atomic<uint64_t> suma{0};
+
+    // Prometheus las quiere acumuladas
+    void valores(std::string& salida) const override {
+        uint64_t acumulado = 0;
+        for (int c = 0; c <= numLimites; ++c) {
+            acumulado += cubetas[c].load(std::memory_order_relaxed);
+            std::string le = c < numLimites ? numero(double(limites[c]) / escala) : "+Inf";
+            salida += std::string(nombre) + "_bucket{le=\"" + le + "\"} " + std::to_string(acumulado) + "\n";
+        }
+        salida += std::string(nombre) + "_sum " + numero(double(suma.load(std::memory_order_relaxed)) / escala) + "\n";
+        salida += std::string(nombre) + "_count " + std::to_string(acumulado) + "\n";
+    }
+};
+
+// Las del piano. Los tiempos se observan en ns y se muestran en segundos.
+struct MetricasPiano {
+    Contador escaneos{"piano_escaneos_total", "Escaneos de la matriz de teclas"};
+    Histograma escaneo{"piano_escaneo_segundos", "Duración de un escaneo de la matriz",
+                       {500000, 1000000, 2000000, 5000000, 10000000, 20000000}, 1e9};
+    Contador notas{"piano_notas_total", "Teclas apretadas mandadas al audio"};
+    Contador eventosPerdidos{"piano_eventos_perdidos_total", "Eventos de nota descartados con la cola llena"};
+    Histograma latenciaEvento{"piano_latencia_evento_segundos",
+                              "Del escaneo que vio la tecla al periodo de audio que la toca (sin el periodo fijo)",
+                              {1000000, 2000000, 5000000, 10000000, 20000000, 50000000}, 1e9};
+    Contador periodos{"piano_periodos_audio_total", "Periodos de audio renderizados"};
+    Histograma cargaAudio{"piano_carga_audio", "Tiempo de render de un periodo sobre la duración del periodo",
+                          {50, 100, 200, 300, 500, 750, 1000}, 1000};
+    Medidor cargaMedia{"piano_carga_audio_media", "Media móvil de la carga del audio", 1000};
+    Contador periodosTarde{"piano_periodos_tarde_total", "Periodos cuyo render tardó más que el periodo"};
+    Medidor nivelCarga{"piano_nivel_carga_audio", "Nivel de degradación del audio (0 = normal)"};
+    Contador sinObservador{"piano_degradar_observador_total", "Veces que se dejó de alimentar el medidor de nivel por carga"};
+    Contador sintesisCache{"piano_degradar_cache_total", "Veces que se pasó a sintetizar desde el cache por carga"};
+    Contador menosVoces{"piano_degradar_voces_total", "Veces que se quitaron voces por carga"};
+    Contador recuperaciones{"piano_recuperar_carga_total", "Niveles de degradación deshechos con la carga baja"};
+    Medidor voces{"piano_voces_activas", "Voces sonando al final del último periodo"};
+    Contador robos{"piano_voces_robadas_total", "Notas que tomaron una voz que sonaba"};
+    Contador quitadas{"piano_voces_quitadas_total", "Voces apagadas por el tope de voces con sobrecarga"};
+    Contador xruns{"piano_xruns_total", "Xruns de ALSA recuperados"};
+    Contador fallasAudio{"piano_fallas_audio_total", "Veces que el dispositivo de audio falló y se volvió a abrir"};
+    Medidor audioActivo{"piano_audio_activo", "1 mientras el hilo de audio escribe al dispositivo"};
+    Histograma frameOled{"piano_frame_oled_segundos", "Escritura de un cuadro al panel OLED",
+                         {500000, 1000000, 2000000, 5000000, 10000000, 20000000, 50000000}, 1e9};
+};
+
+inline MetricasPiano metricas;
+
+#endif
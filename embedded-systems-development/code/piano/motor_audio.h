@@ -0,0 +1,367 @@
+#ifndef MOTOR_AUDIO_H
+#define MOTOR_AUDIO_H
+
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <unistd.h>
+#include "sintetizador.h"
+#include "linea_tiempo.h"
+#include "salida_alsa.h"
+#include "cola_eventos.h"
+#include "carga_audio.h"
+#include "registro.h"
+#include "tiempo_real.h"
+#include "vigilante_rt.h"
+#include "metricas.h"
+#include "traza.h"
+
+#define TAM_COLA_EVENTOS 256
+#define NUM_CUBETAS_RETRASO 7
+#define REINTENTOS_AUDIO 8             // veces que se reabre el dispositivo antes de rendirse
+#define ESPERA_REINTENTO_MS 100        // antes del primer intento; se duplica en cada uno
+#define ESPERA_REINTENTO_MAX_MS 2000
+
+// Límites superiores en us de cada cubeta del histograma; la última es "más"
+const double limitesRetraso[NUM_CUBETAS_RETRASO - 1] = { 50, 100, 200, 500, 1000, 2000 };
+
+// Qué tan tarde vuelve el hilo de audio: cada escritura bloquea hasta que
+// ALSA tiene lugar para un periodo, así que el tiempo entre dos regresos
+// debería ser un periodo; lo que pasa de eso es retraso en despertar.
+struct EstadisticasAudio {
+    uint64_t periodos = 0;
+    double peorRetrasoUs = 0;
+    uint64_t histograma[NUM_CUBETAS_RETRASO] = {};
+    uint64_t robos = 0;       // notas que se quedaron sin voz
+    int picoVoces = 0;
+};
+
+// Nota pedida por el escaneo, con el momento (CLOCK_MONOTONIC) en que se leyó
+struct EventoTeclado {
+    uint64_t ns;
+    int nota;       // -1 = todas
+    bool encender;
+};
+
+inline uint64_t ahoraNs() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return uint64_t(t.tv_sec) * 1000000000ull + uint64_t(t.tv_nsec);
+}
+
+// Hilo de audio que vive todo lo que vive el programa: la salida PCM se abre
+// una vez y nunca se detiene (sin notas escribe silencio), así que empezar a
+// tocar no cuesta reabrir ALSA. Las notas llegan por una cola sin bloqueos.
+//
+// Cada periodo renderiza los eventos que llegaron durante el periodo anterior,
+// colocando cada uno en la muestra que le corresponde según su marca de
+// tiempo. Eso agrega un periodo fijo de latencia pero conserva el tiempo
+// exacto entre notas, en vez de redondearlo al inicio del periodo.
+class MotorAudio {
+public:
+    // Se llama en el hilo de audio con cada periodo ya renderizado (en dos
+    // partes si el buffer DMA da la vuelta en medio)
+    typedef void (*Observador)(const int16_t* muestras, int frames, void* contexto);
+
+    // Prioridad SCHED_FIFO y núcleo del hilo de audio; llamar antes de abrir()
+    void configurarTiempoReal(int prioridad, int cpu) {
+        prioridadRt = prioridad;
+        cpuRt = cpu;
+    }
+
+    // Viva o bucles pre-renderizados; llamar antes de abrir()
+    void fijarModoSintesis(ModoSintesis modo) { sinte.fijarModo(modo); }
+
+    // Flotante o Q15; llamar antes de abrir()
+    void fijarAritmetica(Aritmetica a) { sinte.fijarAritmetica(a); }
+
+    // Número de voces y a cuál se le quita la nota; llamar antes de abrir()
+    void fijarPolifonia(int voces, PoliticaRobo politica) { sinte.fijarPolifonia(voces, politica); }
+
+    // Tiempos del ADSR; llamar antes de abrir()
+    void fijarEnvolvente(const Envolvente& e) { sinte.fijarEnvolvente(e); }
+
+    // Con sobrecarga baja de nivel (piano/carga_audio.h); sin esto siempre
+    // renderiza lo pedido aunque no llegue. Llamar antes de abrir().
+    void fijarDegradacion(bool activa) { degradar = activa; }
+
+    bool abrir(const char* dispositivo, int periodo, int periodos) {
+        ConfigAlsa config;
+        config.dispositivo = dispositivo;
+        config.periodo = unsigned(periodo);
+        config.periodos = unsigned(periodos);
+        return abrir(config);
+    }
+
+    // Con mmap el sintetizador escribe directo en el buffer DMA
+    bool abrir(const ConfigAlsa& config) {
+        if (!salida.abrir(config, FRECUENCIA_MUESTREO)) return false;
+        frames = std::min(int(salida.tamPeriodo()), MAX_PERIODO);
+        modoPedido = sinte.modoActual();
+        if (degradar) {
+            // El cache se arma acá: armarlo en el hilo de audio pide memoria
+            CacheBucles::global();
+            carga.iniciar(nivelMaximoCarga(sinte.polifoniaActual()), frames * 1e6 / FRECUENCIA_MUESTREO);
+        }
+        corriendo = true;
+        enMarcha.store(true, std::memory_order_release);
+        metricas.audioActivo.fijar(1);
+        hilo = std::thread(&MotorAudio::bucle, this);
+        return true;
+    }
+
+    // Entre abrir() y cerrar(); false antes si el dispositivo falló y no
+    // volvió en REINTENTOS_AUDIO intentos: el hilo terminó y ya no suena nada
+    bool funcionando() const { return enMarcha.load(std::memory_order_acquire); }
+
+    void cerrar() {
+        if (corriendo) {
+            corriendo = false;
+            hilo.join();
+        }
+        enMarcha.store(false, std::memory_order_release);
+        metricas.audioActivo.fijar(0);
+        salida.cerrar();
+    }
+
+    // Solo el hilo principal llama a estas tres. ns es cuándo se leyó la tecla.
+    void notaOn(int nota, uint64_t ns = ahoraNs()) {
+        metricas.notas.sumar();
+        if (cola.poner({ns, nota, true})) TRAZA_SALE(TRAZA_ENCOLADO, idFlechaTraza(ns, nota));
+        else metricas.eventosPerdidos.sumar();
+    }
+    void notaOff(int nota, uint64_t ns = ahoraNs()) {
+        if (cola.poner({ns, nota, false})) TRAZA_SALE(TRAZA_ENCOLADO, idFlechaTraza(ns, nota));
+        else metricas.eventosPerdidos.sumar();
+    }
+    void silenciar(uint64_t ns = ahoraNs()) { cola.poner({ns, -1, false}); }
+
+    void observar(Observador o, void* contexto) {
+        contextoObservador.store(contexto, std::memory_order_relaxed);
+        observador.store(o, std::memory_order_release);
+    }
+
+    uint64_t muestrasAudibles() const { return salida.muestrasAudibles(); }
+    uint64_t muestrasEscritas() const { return salida.muestrasEscritas(); }
+    uint64_t xruns() const { return salida.cantidadXruns(); }
+    int tamPeriodo() const { return frames; }
+    int tamBuffer() const { return int(salida.tamBufferAlsa()); }
+    bool usaMmap() const { return salida.usaMmap(); }
+
+    // Lo que se negoció con ALSA
+    void imprimirConfiguracion(FILE* destino = stdout) const {
+        fprintf(destino, "Audio: periodo %d, buffer %lu muestras (%.1f ms), %s\n", frames,
+                (unsigned long)salida.tamBufferAlsa(), salida.tamBufferAlsa() * 1000.0 / FRECUENCIA_MUESTREO,
+                salida.usaMmap() ? "mmap" : "writei");
+    }
+
+    // Leerlas después de cerrar()
+    const EstadisticasAudio& estadisticas() const { return stats; }
+
+    void imprimirEstadisticas(FILE* destino = stdout) const {
+        fprintf(destino, "Audio: %llu periodos, %llu xruns, peor retraso al despertar %.0f us\n",
+                (unsigned long long)stats.periodos, (unsigned long long)salida.cantidadXruns(), stats.peorRetrasoUs);
+        for (int i = 0; i < NUM_CUBETAS_RETRASO; ++i) {
+            if (i < NUM_CUBETAS_RETRASO - 1) fprintf(destino, "  < %5.0f us: %llu\n", limitesRetraso[i], (unsigned long long)stats.histograma[i]);
+            else fprintf(destino, "  más:        %llu\n", (unsigned long long)stats.histograma[i]);
+        }
+        fprintf(destino, "Voces: hasta %d de %d sonando a la vez, %llu robadas (%s)\n", stats.picoVoces,
+                sinte.polifoniaActual(), (unsigned long long)stats.robos, nombresPolitica[sinte.politicaActual()]);
+        if (degradar)
+            fprintf(destino, "Carga: pico %.1f%% del periodo, %llu periodos tarde, %llu veces degradado, %llu recuperado, %llu voces quitadas\n",
+                    carga.cargaPico() / 10.0, (unsigned long long)carga.periodosTarde(),
+                    (unsigned long long)carga.vecesDegradado(), (unsigned long long)carga.vecesRecuperado(),
+                    (unsigned long long)sinte.vocesQuitadas());
+    }
+
+private:
+    SalidaAlsa salida;
+    Sintetizador sinte;
+    ColaEventos<EventoTeclado, TAM_COLA_EVENTOS> cola;
+    std::thread hilo;
+    std::atomic<bool> corriendo{false};
+    std::atomic<bool> enMarcha{false};
+    std::atomic<Observador> observador{nullptr};
+    std::atomic<void*> contextoObservador{nullptr};
+    int frames = 0;
+    int prioridadRt = 0;
+    int cpuRt = -1;
+    EstadisticasAudio stats;
+    bool degradar = true;
+    bool usarObservador = true;
+    ModoSintesis modoPedido = SINTESIS_VIVA;
+    ControlCarga carga;
+
+    static double ahoraUs() {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+    }
+
+    void registrarRetraso(double intervaloUs) {
+        double retraso = intervaloUs - frames * 1e6 / FRECUENCIA_MUESTREO;
+        if (retraso < 0) retraso = 0;
+        if (retraso > stats.peorRetrasoUs) stats.peorRetrasoUs = retraso;
+        int c = 0;
+        while (c < NUM_CUBETAS_RETRASO - 1 && retraso >= limitesRetraso[c]) ++c;
+        ++stats.histograma[c];
+        ++stats.periodos;
+    }
+
+    // Mide el periodo contra su plazo y, si el control de carga lo pide,
+    // cambia de nivel. Cada cambio se cuenta y queda en el registro.
+    void controlarCarga(uint32_t cargaPeriodo) {
+        ZonaTiempoReal zona;
+        int cambio = carga.observar(cargaPeriodo);
+        metricas.cargaMedia.fijar(carga.cargaMedia());
+        metricas.periodosTarde.fijar(carga.periodosTarde());
+        if (cambio == 0) return;
+
+        int nivel = carga.nivel();
+        usarObservador = nivel < CARGA_SIN_OBSERVADOR;
+        sinte.fijarModo(nivel >= CARGA_SINTESIS_CACHE ? SINTESIS_CACHE : modoPedido);
+        sinte.limitarVoces(vocesEnNivel(nivel, sinte.polifoniaActual()));
+
+        if (cambio < 0) metricas.recuperaciones.sumar();
+        else if (nivel == CARGA_SIN_OBSERVADOR) metricas.sinObservador.sumar();
+        else if (nivel == CARGA_SINTESIS_CACHE) metricas.sintesisCache.sumar();
+        else metricas.menosVoces.sumar();
+        metricas.nivelCarga.fijar(nivel);
+        registrar(REG_CARGA_AUDIO, nivel, int32_t(carga.cargaMedia()), int32_t(cargaPeriodo), nombreNivelCarga(nivel));
+    }
+
+    // Adapta la cola a renderConEventos: pasa la marca de tiempo de cada
+    // evento a su muestra dentro del periodo. Los eventos de [desdeNs, hastaNs)
+    // se reparten en el periodo que empieza en "reloj"; los que llegaron
+    // después caen fuera y quedan para el siguiente. Nota -1 apaga todas.
+    struct FuenteCola {
+        ColaEventos<EventoTeclado, TAM_COLA_EVENTOS>& cola;
+        Sintetizador& sinte;
+        uint64_t reloj = 0;
+        uint64_t desdeNs = 0;
+        uint64_t hastaNs = 0;
+        int frames = 0;
+        EventoNota actual{};
+
+        const EventoNota* proximo() {
+            const EventoTeclado* e = cola.frente();
+            if (!e) return nullptr;
+            uint64_t offset = 0;
+            if (desdeNs && e->ns > desdeNs)
+                offset = (e->ns - desdeNs) * uint64_t(frames) / (hastaNs > desdeNs ? hastaNs - desdeNs : 1);
+            actual = {reloj + offset, e->nota, e->encender};
+            return &actual;
+        }
+
+        void avanzar() {
+            if (actual.nota < 0) sinte.apagarTodas();
+            const EventoTeclado* e = cola.frente();
+            if (hastaNs > e->ns) metricas.latenciaEvento.observar(hastaNs - e->ns);
+            TRAZA_LLEGA(TRAZA_SACADO, idFlechaTraza(e->ns, e->nota));
+            cola.sacar();
+        }
+    };
+
+    // El dispositivo dejó de andar (un DAC USB desconectado, un error que
+    // snd_pcm_recover no arregla): se cuenta, se registra y se vuelve a abrir
+    // esperando cada vez el doble. Devuelve false si no volvió o si se pidió
+    // cerrar mientras tanto.
+    bool volverAAbrir() {
+        metricas.fallasAudio.sumar();
+        metricas.audioActivo.fijar(0);
+        registrarTexto("El dispositivo de audio falló, se vuelve a abrir");
+        int esperaMs = ESPERA_REINTENTO_MS;
+        for (int intento = 0; intento < REINTENTOS_AUDIO; ++intento) {
+            for (int ms = 0; ms < esperaMs; ms += 10) {
+                if (!corriendo) return false;
+                usleep(10000);
+            }
+            if (salida.reabrir()) {
+                metricas.audioActivo.fijar(1);
+                registrarTexto("El dispositivo de audio volvió");
+                return true;
+            }
+            esperaMs = std::min(esperaMs * 2, ESPERA_REINTENTO_MAX_MS);
+        }
+        registrarTexto("El dispositivo de audio no volvió, el audio se detiene");
+        return false;
+    }
+
+    void bucle() {
+        if (prioridadRt > 0 || cpuRt >= 0) fijarTiempoReal(prioridadRt, cpuRt, "audio");
+        prefaultPila();
+        TRAZA_NOMBRE_HILO("audio");
+
+        FuenteCola fuente{cola, sinte};
+        fuente.frames = frames;
+        uint64_t reloj = 0;
+        double anterior = 0;
+        while (corriendo) {
+            fuente.reloj = reloj;
+            fuente.desdeNs = fuente.hastaNs;
+            fuente.hastaNs = ahoraNs();
+
+            // El periodo puede llegar en dos tramos si el buffer DMA da la vuelta
+            int hechas = 0;
+            uint64_t renderNs = 0;
+            bool error = false;
+            while (hechas < frames) {
+                int n = frames - hechas;
+                TRAZA_INICIO(TRAZA_ALSA);
+                int16_t* destino = salida.reservar(n);
+                TRAZA_FIN(TRAZA_ALSA);
+                if (!destino) {
+                    error = true;
+                    break;
+                }
+                {
+                    // Lo que no puede bloquear; reservar y confirmar sí esperan a ALSA
+                    ZonaTiempoReal zona;
+                    TRAZA_INICIO(TRAZA_PERIODO);
+                    uint64_t t0 = ahoraNs();
+                    renderConEventos(sinte, fuente, reloj + hechas, destino, n);
+                    Observador o = observador.load(std::memory_order_acquire);
+                    if (o && usarObservador) o(destino, n, contextoObservador.load(std::memory_order_relaxed));
+                    renderNs += ahoraNs() - t0;
+                    TRAZA_FIN(TRAZA_PERIODO);
+                }
+                TRAZA_INICIO(TRAZA_ALSA);
+                bool confirmado = salida.confirmar(n);
+                TRAZA_FIN(TRAZA_ALSA);
+                if (!confirmado) {
+                    error = true;
+                    break;
+                }
+                hechas += n;
+            }
+            if (error) {
+                if (volverAAbrir()) {
+                    anterior = 0;
+                    continue;
+                }
+                if (corriendo) enMarcha.store(false, std::memory_order_release);
+                break;
+            }
+            stats.picoVoces = std::max(stats.picoVoces, sinte.vocesActivas());
+            stats.robos = sinte.robos();
+            reloj += frames;
+            metricas.periodos.sumar();
+            uint32_t cargaPeriodo = uint32_t(renderNs * FRECUENCIA_MUESTREO / 1000000ull / uint64_t(frames));
+            metricas.cargaAudio.observar(cargaPeriodo);
+            if (degradar) controlarCarga(cargaPeriodo);
+            metricas.voces.fijar(sinte.vocesActivas());
+            metricas.robos.fijar(sinte.robos());
+            metricas.quitadas.fijar(sinte.vocesQuitadas());
+            metricas.xruns.fijar(salida.cantidadXruns());
+
+            // Mientras se llena el buffer de ALSA las escrituras no bloquean
+            double ahora = ahoraUs();
+            if (anterior > 0 && salida.muestrasEscritas() > salida.muestrasAudibles() + frames) registrarRetraso(ahora - anterior);
+            anterior = ahora;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef PINES_H
+#define PINES_H
+
+// Líneas de gpiochip0 que usa el piano (números de línea del T113)
+#define CHIPNAME "gpiochip0"
+
+// Matriz de teclas: 74HC595 activa columnas, 74HC165 lee filas
+#define PIN_SER_OUT   193
+#define PIN_CLK_OUT   194
+#define PIN_LATCH_OUT 192
+#define PIN_SER_IN    128
+#define PIN_CLK_IN    129
+#define PIN_LATCH_IN   39
+
+// Matriz de LEDs: un 74HC595 para columnas y otro para filas
+#define PIN_SER_COL   195
+#define PIN_CLK_COL   197
+#define PIN_LATCH_COL 196
+#define PIN_SER_ROW   38
+#define PIN_CLK_ROW   37
+#define PIN_LATCH_ROW 36
+
+// Botones del menú
+#define PIN_IZQ 132
+#define PIN_ENT 133
+#define PIN_DER 134
+
+// La tecla en [columna][fila] es la nota cromática fila * 5 + columna (0 = C4, 24 = C6)
+inline int notaEnMatriz(int col, int row) { return row * 5 + col; }
+
+#endif
@@ -7,6 +7,10 @@
 #include <csignal>   // para kill
 #include <sys/types.h>
 #include <sys/wait.h>
+#include "../oled/pantalla.h"
+#include "../oled/fuente.h"
+#include "registro.h"
+#include "sintetizador.h"
 
 #define CHIPNAME "gpiochip0"
 #define CONSUMER "piano"
@@ -32,6 +36,10 @@ gpiod_line *serOut, *clkOut, *latchOut;
 gpiod_line *serIn, *clkIn, *latchIn;
 
 std::map<std::string, pid_t> procesosActivos;
+std::map<std::string, int> indiceDe;
+
+Pantalla pantalla;
+bool hayPantalla = false;
 
 void pulse(gpiod_line *line) {
     gpiod_line_set_value(line, 1);
@@ -96,7 +104,7 @@ void tocarNota(const std::string& nota) {
             _exit(1); // por si falla
         }
         procesosActivos[nota] = pid;
-        std::cout << "Tocando: " << nota << " (PID: " << pid << ")\n";
+        registrar(REG_NOTA_ON, indiceDe[nota], 0, 0, nombreNota(indiceDe[nota]));
     }
 }
 
@@ -106,10 +114,20 @@ void apagarNota(const std::string& nota) {
         kill(pid, SIGTERM);
         waitpid(pid, nullptr, 0); // limpia proceso zombie
         procesosActivos.erase(nota);
-        std::cout << "Nota parada: " << nota << "\n";
+        registrar(REG_NOTA_OFF, indiceDe[nota], 0, 0, nombreNota(indiceDe[nota]));
     }
 }
 
+// Indicador en el borde derecho de la pantalla: una celda por tecla, de C4
+// (arriba) a C6 (abajo). Ocupa una sola página del framebuffer, así que
+// actualizarlo no repinta el resto de la imagen.
+void dibujarIndicador(const std::string& nota, bool presionada) {
+    if (!hayPantalla) return;
+    pantalla.rectangulo(ANCHO_VISIBLE - 3, 14 + 4 * indiceDe[nota], 3, 3, presionada);
+    // La pantalla normal es una plantilla: debajo del dibujo va la última nota tocada
+    if (presionada) escribirCampo(pantalla, 8, CAMPO_NORMAL_NOTA_R, 8, nota.c_str());
+}
+
 void apagarTodas() {
     for (auto& [nota, pid] : procesosActivos) {
         kill(pid, SIGTERM);
@@ -124,6 +142,13 @@ int main() {
         return 1;
     }
 
+    for (int col = 0; col < 5; ++col)
+        for (int row = 0; row < 5; ++row)
+            indiceDe[notes[col][row]] = row * 5 + col;
+
+    hayPantalla = pantalla.abrir();
+    Registro::global().iniciar();
+
     std::map<std::string, bool> estadoAnterior;
 
     while (true) {
@@ -149,10 +174,13 @@ int main() {
             bool antes = estadoAnterior[nota];
             if (presionada && !antes) {
                 tocarNota(nota);
+                dibujarIndicador(nota, true);
             } else if (!presionada && antes) {
                 apagarNota(nota);
+                dibujarIndicador(nota, false);
             }
         }
+        if (hayPantalla) pantalla.actualizar();
 
         estadoAnterior = estadoActual;
         usleep(30000); // 30 ms
@@ -160,5 +188,6 @@ int main() {
 
     apagarTodas();
     gpiod_chip_close(chip);
+    Registro::global().detener();
     return 0;
 }
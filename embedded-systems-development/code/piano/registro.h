@@ -0,0 +1,192 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include "cola_eventos.h"
+
+// Registro para los bucles que no pueden esperar a la consola serie: quien
+// registra solo escribe un registro binario de tamaño fijo en el anillo de su
+// hilo (sin bloqueos, sin formatear, sin llamadas al sistema). Un hilo de baja
+// prioridad los junta, los ordena por tiempo, les da formato y los escribe en
+// la consola o en un archivo. Si un anillo se llena, el registro se descarta
+// y se cuenta. Los nombres (de notas, de niveles) los pone quien registra en
+// "texto", así el registro no depende del sintetizador ni del audio.
+
+#define MAX_HILOS_REGISTRO 8
+#define TAM_ANILLO_REGISTRO 512
+#define INTERVALO_REGISTRO_MS 50
+#define NICE_REGISTRO 19
+
+enum TipoRegistro : uint16_t {
+    REG_NOTA_ON,          // a = nota, texto = su nombre
+    REG_NOTA_OFF,         // a = nota, texto = su nombre
+    REG_TUTOR_ESPERA,     // a = nota esperada, b = posición, c = total, texto = nombre de la nota
+    REG_TUTOR_FIN,        // a = notas tocadas
+    REG_CAMBIO_MODO,      // a = modo (ver nombresModo), b = microsegundos
+    REG_CARGA_AUDIO,      // a = nivel nuevo, b = carga media y c = del periodo, en milésimas, texto = nombre del nivel
+    REG_TEXTO             // texto = cadena literal o que viva todo el programa
+};
+
+const char* const nombresModo[] = { "menú", "modo normal", "tutor" };
+
+struct RegistroBinario {
+    uint64_t ns;
+    uint16_t tipo;
+    uint16_t hilo;
+    int32_t a, b, c;
+    const char* texto;
+};
+
+class Registro {
+public:
+    static Registro& global() {
+        static Registro r;
+        return r;
+    }
+
+    // destino = nullptr escribe en stdout
+    bool iniciar(const char* destino = nullptr) {
+        if (corriendo) return true;
+        salida = destino ? fopen(destino, "a") : stdout;
+        if (!salida) {
+            perror("No se pudo abrir el archivo de registro");
+            salida = stdout;
+            return false;
+        }
+        corriendo = true;
+        hilo = std::thread(&Registro::bucle, this);
+        return true;
+    }
+
+    // Vacía lo que quede y cierra
+    void detener() {
+        if (!corriendo) return;
+        corriendo = false;
+        hilo.join();
+        if (salida && salida != stdout) fclose(salida);
+        salida = stdout;
+    }
+
+    void registrar(TipoRegistro tipo, int32_t a, int32_t b, int32_t c, const char* texto) {
+        Anillo* anillo = anilloDelHilo();
+        if (!anillo) {
+            descartados.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        RegistroBinario r{uint64_t(t.tv_sec) * 1000000000ull + uint64_t(t.tv_nsec), tipo, anillo->id, a, b, c, texto};
+        if (!anillo->cola.poner(r)) descartados.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t registrosDescartados() const { return descartados.load(std::memory_order_relaxed); }
+
+private:
+    struct Anillo {
+        std::atomic<bool> usado{false};
+        uint16_t id = 0;
+        ColaEventos<RegistroBinario, TAM_ANILLO_REGISTRO> cola;
+    };
+
+    Anillo anillos[MAX_HILOS_REGISTRO];
+    std::atomic<uint64_t> descartados{0};
+    std::atomic<bool> corriendo{false};
+    std::thread hilo;
+    FILE* salida = stdout;
+
+    // Cada hilo toma un anillo libre la primera vez que registra
+    Anillo* anilloDelHilo() {
+        thread_local Anillo* propio = nullptr;
+        thread_local bool buscado = false;
+        if (!buscado) {
+            buscado = true;
+            for (uint16_t i = 0; i < MAX_HILOS_REGISTRO; ++i) {
+                bool libre = false;
+                if (anillos[i].usado.compare_exchange_strong(libre, true)) {
+                    anillos[i].id = i;
+                    propio = &anillos[i];
+                    break;
+                }
+            }
+        }
+        return propio;
+    }
+
+    void bucle() {
+        sched_param normal{};
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+        setpriority(PRIO_PROCESS, pid_t(syscall(SYS_gettid)), NICE_REGISTRO);
+
+        std::vector<RegistroBinario> lote;
+        lote.reserve(MAX_HILOS_REGISTRO * TAM_ANILLO_REGISTRO);
+        uint64_t descartadosAntes = 0;
+        bool seguir = true;
+        while (seguir) {
+            seguir = corriendo;
+            if (seguir) usleep(INTERVALO_REGISTRO_MS * 1000);
+
+            lote.clear();
+            for (auto& anillo : anillos) {
+                if (!anillo.usado.load(std::memory_order_acquire)) continue;
+                const RegistroBinario* r;
+                while ((r = anillo.cola.frente())) {
+                    lote.push_back(*r);
+                    anillo.cola.sacar();
+                }
+            }
+            std::sort(lote.begin(), lote.end(), [](const RegistroBinario& x, const RegistroBinario& y) { return x.ns < y.ns; });
+            for (const auto& r : lote) escribir(r);
+
+            uint64_t d = descartados.load(std::memory_order_relaxed);
+            if (d != descartadosAntes) {
+                fprintf(salida, "[registro] %llu registros descartados\n", (unsigned long long)(d - descartadosAntes));
+                descartadosAntes = d;
+            }
+            if (!lote.empty()) fflush(salida);
+        }
+    }
+
+    static const char* nombre(const RegistroBinario& r) { return r.texto ? r.texto : "?"; }
+
+    void escribir(const RegistroBinario& r) {
+        fprintf(salida, "%llu.%06llu [%u] ", (unsigned long long)(r.ns / 1000000000ull),
+                (unsigned long long)(r.ns % 1000000000ull / 1000), unsigned(r.hilo));
+        switch (r.tipo) {
+            case REG_NOTA_ON:      fprintf(salida, "Tocando: %s\n", nombre(r)); break;
+            case REG_NOTA_OFF:     fprintf(salida, "Nota parada: %s\n", nombre(r)); break;
+            case REG_TUTOR_ESPERA: fprintf(salida, "Toca la nota: %s (%d/%d)\n", nombre(r), r.b, r.c); break;
+            case REG_TUTOR_FIN:    fprintf(salida, "Canción terminada: %d notas\n", r.a); break;
+            case REG_CAMBIO_MODO:
+                fprintf(salida, "Cambio a %s: %.3f ms\n", r.a >= 0 && r.a < 3 ? nombresModo[r.a] : "?", r.b / 1000.0);
+                break;
+            case REG_CARGA_AUDIO:
+                fprintf(salida, "Audio: nivel de carga %d (%s), carga media %.1f%%, último periodo %.1f%%\n", r.a,
+                        nombre(r), r.b / 10.0, r.c / 10.0);
+                break;
+            case REG_TEXTO:        fprintf(salida, "%s\n", r.texto ? r.texto : ""); break;
+            default:               fprintf(salida, "registro desconocido %u\n", unsigned(r.tipo)); break;
+        }
+    }
+};
+
+// "texto" tiene que vivir todo el programa (un literal o una tabla constante)
+inline void registrar(TipoRegistro tipo, int32_t a = 0, int32_t b = 0, int32_t c = 0, const char* texto = nullptr) {
+    Registro::global().registrar(tipo, a, b, c, texto);
+}
+
+inline void registrarTexto(const char* texto) {
+    Registro::global().registrar(REG_TEXTO, 0, 0, 0, texto);
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "sintetizador.h"
+#include "linea_tiempo.h"
+#include "archivo_wav.h"
+#include "captura.h"
+#include "vigilante_rt.h"
+#include "../tutor/canciones.h"
+
+// Renderiza sin ALSA y tan rápido como dé la CPU una canción del tutor o un
+// registro de teclas (main_menu --registro) o una captura del escaneo
+// (main_menu --capturar), con el mismo sintetizador y el mismo tamaño de
+// periodo que el piano, y lo guarda en un WAV. Al final dice
+// cuánto tardó frente a lo que dura el audio (factor de tiempo real).
+// Compilado con -DVIGILAR_RT, el render de cada periodo corre en una zona
+// de tiempo real (ver vigilante_rt.h) y al final dice cuántas violaciones hubo.
+//
+// Uso: ./renderizar (canción | archivo.cancion | --registro archivo | --captura archivo) salida.wav
+//          [--bpm N] [--cache] [--q15] [--polifonia N] [--robo vieja|suave|grave] [--periodo N]
+
+#define PERIODO 256
+
+double ahoraSeg(clockid_t reloj) {
+    timespec t;
+    clock_gettime(reloj, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " (canción | archivo.cancion | --registro archivo | --captura archivo) salida.wav"
+                  << " [--bpm N] [--cache] [--q15] [--polifonia N] [--robo vieja|suave|grave] [--periodo N]\n";
+        return 1;
+    }
+
+    int primero = 1;
+    const char* registro = nullptr;
+    const char* captura = nullptr;
+    if (!strcmp(argv[1], "--registro")) {
+        registro = argv[2];
+        primero = 2;
+    } else if (!strcmp(argv[1], "--captura")) {
+        captura = argv[2];
+        primero = 2;
+    }
+    if (primero + 1 >= argc) {
+        std::cerr << "Falta el archivo de salida\n";
+        return 1;
+    }
+    std::string entrada = argv[primero];
+    std::string salida = argv[primero + 1];
+
+    int bpm = 0, polifonia = POLIFONIA, periodo = PERIODO;
+    PoliticaRobo politica = ROBAR_VIEJA;
+    Sintetizador sinte;
+    for (int i = primero + 2; i < argc; ++i) {
+        std::string opcion = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (opcion == "--cache") sinte.fijarModo(SINTESIS_CACHE);
+        else if (opcion == "--q15") sinte.fijarAritmetica(ARITMETICA_Q15);
+        else if (opcion == "--bpm" && hayValor) bpm = atoi(argv[++i]);
+        else if (opcion == "--polifonia" && hayValor) polifonia = atoi(argv[++i]);
+        else if (opcion == "--periodo" && hayValor) periodo = std::max(1, std::min(atoi(argv[++i]), MAX_PERIODO));
+        else if (opcion == "--robo" && hayValor) {
+            int p = indicePolitica(argv[++i]);
+            if (p < 0) std::cerr << "Política de robo desconocida: " << argv[i] << "\n";
+            else politica = PoliticaRobo(p);
+        }
+    }
+    sinte.fijarPolifonia(polifonia, politica);
+
+    LineaTiempo linea;
+    if (registro) {
+        int notas = lineaDeRegistro(registro, linea);
+        if (notas < 0) {
+            std::cerr << "No se pudo abrir " << registro << "\n";
+            return 1;
+        }
+        std::cout << "Registro " << registro << ": " << notas << " notas\n";
+    } else if (captura) {
+        int notas = lineaDeCaptura(captura, linea);
+        if (notas < 0) {
+            std::cerr << "No se pudo leer la captura " << captura << "\n";
+            return 1;
+        }
+        std::cout << "Captura " << captura << ": " << notas << " notas\n";
+    } else {
+        Cancion cargada;
+        const Cancion* cancion = buscarCancion(entrada);
+        if (!cancion && cargarCancion(entrada, cargada)) cancion = &cargada;
+        if (!cancion) {
+            std::cerr << "Canción desconocida, opciones: estrellita, hbd, piratas, pollitos o un archivo .cancion\n";
+            return 1;
+        }
+        linea = lineaDeCancion(*cancion, bpm > 0 ? bpm : cancion->bpm);
+        std::cout << "Canción " << cancion->nombre << ": " << cancion->notas.size() << " notas\n";
+    }
+
+    EscritorWav wav;
+    if (!wav.abrir(salida, FRECUENCIA_MUESTREO)) {
+        std::cerr << "No se pudo crear " << salida << "\n";
+        return 1;
+    }
+
+    // Hasta el último evento y después hasta que se apague la última voz
+    int16_t buffer[MAX_PERIODO];
+    uint64_t reloj = 0;
+    int picoVoces = 0;
+    double renderSeg = 0;
+    double inicioPared = ahoraSeg(CLOCK_MONOTONIC);
+    double inicioCpu = ahoraSeg(CLOCK_PROCESS_CPUTIME_ID);
+    while (!linea.terminada() || sinte.vocesActivas() > 0) {
+        double t0 = ahoraSeg(CLOCK_PROCESS_CPUTIME_ID);
+        {
+            ZonaTiempoReal zona;
+            linea.renderPeriodo(sinte, reloj, buffer, periodo);
+        }
+        renderSeg += ahoraSeg(CLOCK_PROCESS_CPUTIME_ID) - t0;
+        picoVoces = std::max(picoVoces, sinte.vocesActivas());
+        if (!wav.escribir(buffer, size_t(periodo))) {
+            std::cerr << "Error escribiendo " << salida << "\n";
+            return 1;
+        }
+        reloj += uint64_t(periodo);
+    }
+    double pared = ahoraSeg(CLOCK_MONOTONIC) - inicioPared;
+    double cpu = ahoraSeg(CLOCK_PROCESS_CPUTIME_ID) - inicioCpu;
+    if (!wav.cerrar()) {
+        std::cerr << "Error cerrando " << salida << "\n";
+        return 1;
+    }
+
+    // Factor de tiempo real: segundos de proceso por segundo de audio
+    double audio = double(reloj) / FRECUENCIA_MUESTREO;
+    std::cout << salida << ": " << audio << " s de audio en " << pared * 1000 << " ms ("
+              << pared / audio << " RTF, " << audio / pared << "x tiempo real)\n";
+    std::cout << "Solo síntesis: " << renderSeg * 1000 << " ms de CPU (" << renderSeg / audio
+              << " RTF), total con el archivo " << cpu * 1000 << " ms\n";
+    std::cout << "Voces: hasta " << picoVoces << " de " << sinte.polifoniaActual() << ", "
+              << sinte.robos() << " robadas; " << (sinte.aritmeticaActual() == ARITMETICA_Q15 ? "Q15" : "flotante")
+              << (sinte.modoActual() == SINTESIS_CACHE ? " con cache" : " viva") << ", periodo " << periodo << "\n";
+#ifdef VIGILAR_RT
+    std::cout << "Vigilante RT: " << violacionesTiempoReal() << " violaciones\n";
+    if (violacionesTiempoReal()) return 2;
+#endif
+    return 0;
+}
@@ -0,0 +1,280 @@
+#ifndef SALIDA_ALSA_H
+#define SALIDA_ALSA_H
+
+#include <alsa/asoundlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#define PERIODO_ALSA 256
+#define PERIODOS_ALSA 4
+#define PERIODO_BAJA_LATENCIA 64     // 1.3 ms a 48 kHz
+#define PERIODOS_BAJA_LATENCIA 2
+#define ESPERA_ALSA_MS 1000          // sin lugar en este tiempo el dispositivo se da por caído
+
+// Dispositivo, tamaño de periodo y número de periodos que se piden a ALSA.
+// Son pedidos: abrir() se queda con lo más cercano que acepte el hardware.
+struct ConfigAlsa {
+    const char* dispositivo = "default";
+    unsigned int periodo = PERIODO_ALSA;
+    unsigned int periodos = PERIODOS_ALSA;
+    bool mmap = true;
+};
+
+// Lee --dispositivo X, --periodo N, --periodos N, --baja-latencia y --sin-mmap
+inline void leerConfigAlsa(int argc, char** argv, ConfigAlsa& config) {
+    for (int i = 1; i < argc; ++i) {
+        bool hayValor = i + 1 < argc;
+        if (!strcmp(argv[i], "--dispositivo") && hayValor) config.dispositivo = argv[++i];
+        else if (!strcmp(argv[i], "--periodo") && hayValor) config.periodo = unsigned(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--periodos") && hayValor) config.periodos = unsigned(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--sin-mmap")) config.mmap = false;
+        else if (!strcmp(argv[i], "--baja-latencia")) {
+            config.periodo = PERIODO_BAJA_LATENCIA;
+            config.periodos = PERIODOS_BAJA_LATENCIA;
+        }
+    }
+}
+
+// Salida PCM mono S16 que lleva la cuenta de muestras escritas, para que
+// el resto del programa pueda seguir el reloj de audio.
+//
+// Con mmap, reservar() entrega un puntero dentro del buffer DMA y el
+// sintetizador escribe ahí directamente; confirmar() lo pasa al hardware.
+// Si el dispositivo no acepta mmap se usa un buffer intermedio y writei, con
+// la misma interfaz. Los xruns se recuperan solos y se cuentan.
+class SalidaAlsa {
+public:
+    bool abrir(const char* dispositivo, unsigned int tasa, snd_pcm_uframes_t periodoPedido, unsigned int periodos) {
+        ConfigAlsa config;
+        config.dispositivo = dispositivo;
+        config.periodo = unsigned(periodoPedido);
+        config.periodos = periodos;
+        config.mmap = false;
+        return abrir(config, tasa);
+    }
+
+    bool abrir(const ConfigAlsa& config, unsigned int tasa) {
+        configuracion = config;
+        tasaPedida = tasa;
+        int err = snd_pcm_open(&pcm, config.dispositivo, SND_PCM_STREAM_PLAYBACK, 0);
+        if (err < 0) {
+            std::cerr << "No se pudo abrir " << config.dispositivo << ": " << snd_strerror(err) << "\n";
+            return false;
+        }
+
+        accesoMmap = config.mmap;
+        err = configurar(config, tasa);
+        if (err < 0 && accesoMmap) {
+            std::cerr << config.dispositivo << " no acepta mmap, se usa writei\n";
+            accesoMmap = false;
+            err = configurar(config, tasa);
+        }
+        directo = accesoMmap;
+        if (err < 0) {
+            std::cerr << "Configuración de audio no soportada: " << snd_strerror(err) << "\n";
+            cerrar();
+            return false;
+        }
+
+        // Empieza a sonar cuando el buffer está lleno y despierta con un periodo libre
+        snd_pcm_sw_params_t* sw;
+        snd_pcm_sw_params_malloc(&sw);
+        snd_pcm_sw_params_current(pcm, sw);
+        snd_pcm_sw_params_set_start_threshold(pcm, sw, tamBuffer - tamBuffer % periodo);
+        snd_pcm_sw_params_set_avail_min(pcm, sw, periodo);
+        snd_pcm_sw_params(pcm, sw);
+        snd_pcm_sw_params_free(sw);
+
+        rebote.assign(periodo, 0);
+        escritas = 0;
+        audibles = 0;
+        xruns = 0;
+        return true;
+    }
+
+    // Espacio para hasta "frames" muestras contiguas: dentro del buffer DMA
+    // con mmap, o en el buffer intermedio. Bloquea hasta que haya lugar y deja
+    // en "frames" cuántas se pueden escribir (menos si el buffer da la vuelta).
+    // nullptr si el dispositivo falló o no dejó lugar en ESPERA_ALSA_MS.
+    int16_t* reservar(int& frames) {
+        if (!directo) {
+            frames = std::min(frames, int(rebote.size()));
+            return rebote.data();
+        }
+        while (true) {
+            snd_pcm_sframes_t libres = snd_pcm_avail_update(pcm);
+            if (libres < 0) {
+                if (!recuperar(int(libres))) return nullptr;
+                continue;
+            }
+            if (libres < frames) {
+                // Con el buffer lleno y el PCM parado hay que arrancarlo a mano
+                if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED && snd_pcm_start(pcm) < 0) return nullptr;
+                int err = snd_pcm_wait(pcm, ESPERA_ALSA_MS);
+                if (err == 0) {
+                    // Un dispositivo trabado (un DAC USB desconectado) no da error, solo no avanza
+                    std::cerr << "El dispositivo de audio no avanzó en " << ESPERA_ALSA_MS << " ms\n";
+                    return nullptr;
+                }
+                if (err < 0 && !recuperar(err)) return nullptr;
+                continue;
+            }
+
+            const snd_pcm_channel_area_t* areas;
+            snd_pcm_uframes_t desde, n = snd_pcm_uframes_t(frames);
+            int err = snd_pcm_mmap_begin(pcm, &areas, &desde, &n);
+            if (err < 0) {
+                if (!recuperar(err)) return nullptr;
+                continue;
+            }
+            // Mono S16: las muestras tienen que quedar seguidas de 16 en 16 bits
+            if (areas[0].step != 16 || areas[0].first % 16) {
+                std::cerr << "Disposición mmap inesperada, se copia desde un buffer intermedio\n";
+                snd_pcm_mmap_commit(pcm, desde, 0);
+                directo = false;
+                return reservar(frames);
+            }
+            desdeMmap = desde;
+            frames = int(n);
+            return static_cast<int16_t*>(areas[0].addr) + areas[0].first / 16 + desde;
+        }
+    }
+
+    // Entrega las muestras escritas en lo que devolvió reservar()
+    bool confirmar(int frames) {
+        if (!directo) return copiar(rebote.data(), frames);
+        snd_pcm_sframes_t n = snd_pcm_mmap_commit(pcm, desdeMmap, snd_pcm_uframes_t(frames));
+        // Una confirmación corta no es un xrun: se cuenta lo que entró y el
+        // próximo reservar() sigue desde ahí. Preparar de nuevo un PCM que
+        // anda bien sería justamente el corte que se quiere evitar.
+        if (n < 0) {
+            if (!recuperar(int(n))) return false;
+        } else {
+            escritas += uint64_t(n);
+        }
+        actualizarAudibles();
+        return true;
+    }
+
+    // Escribe un periodo completo desde un buffer propio
+    bool escribir(const int16_t* datos, int frames) {
+        if (!directo) return copiar(datos, frames);
+        while (frames > 0) {
+            int n = frames;
+            int16_t* destino = reservar(n);
+            if (!destino) return false;
+            std::copy(datos, datos + n, destino);
+            if (!confirmar(n)) return false;
+            datos += n;
+            frames -= n;
+        }
+        return true;
+    }
+
+    // Muestra que está sonando en este momento por el parlante
+    uint64_t muestrasAudibles() const { return audibles.load(std::memory_order_acquire); }
+    uint64_t muestrasEscritas() const { return escritas; }
+    snd_pcm_uframes_t tamPeriodo() const { return periodo; }
+    snd_pcm_uframes_t tamBufferAlsa() const { return tamBuffer; }
+    bool usaMmap() const { return directo; }
+    uint64_t cantidadXruns() const { return xruns.load(std::memory_order_relaxed); }
+
+    void drenar() {
+        if (pcm) snd_pcm_drain(pcm);
+        audibles.store(escritas, std::memory_order_release);
+    }
+
+    void cerrar() {
+        if (pcm) snd_pcm_close(pcm);
+        pcm = nullptr;
+    }
+
+    // Cierra y vuelve a abrir con lo que se pidió en abrir(), para cuando el
+    // dispositivo dejó de responder. Las cuentas de muestras y de xruns
+    // siguen desde donde estaban, así el reloj de audio no vuelve atrás.
+    bool reabrir() {
+        uint64_t antes = escritas;
+        uint64_t xrunsAntes = cantidadXruns();
+        cerrar();
+        if (!abrir(configuracion, tasaPedida)) return false;
+        escritas = antes;
+        audibles.store(antes, std::memory_order_release);
+        xruns.store(xrunsAntes, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    snd_pcm_t* pcm = nullptr;
+    ConfigAlsa configuracion;
+    unsigned int tasaPedida = 0;
+    snd_pcm_uframes_t periodo = PERIODO_ALSA;
+    snd_pcm_uframes_t tamBuffer = PERIODO_ALSA * PERIODOS_ALSA;
+    snd_pcm_uframes_t desdeMmap = 0;
+    bool accesoMmap = false;    // el PCM se configuró con acceso mmap
+    bool directo = false;       // y se renderiza dentro del buffer DMA
+    std::vector<int16_t> rebote;
+    uint64_t escritas = 0;
+    std::atomic<uint64_t> audibles{0};
+    std::atomic<uint64_t> xruns{0};
+
+    int configurar(const ConfigAlsa& config, unsigned int tasa) {
+        snd_pcm_hw_params_t* hw;
+        snd_pcm_hw_params_malloc(&hw);
+        snd_pcm_hw_params_any(pcm, hw);
+        int err = snd_pcm_hw_params_set_access(pcm, hw, accesoMmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED);
+        if (err >= 0) err = snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_S16_LE);
+        if (err >= 0) err = snd_pcm_hw_params_set_channels(pcm, hw, 1);
+        if (err >= 0) err = snd_pcm_hw_params_set_rate_near(pcm, hw, &tasa, nullptr);
+        periodo = config.periodo;
+        unsigned int periodos = config.periodos;
+        if (err >= 0) err = snd_pcm_hw_params_set_period_size_near(pcm, hw, &periodo, nullptr);
+        if (err >= 0) err = snd_pcm_hw_params_set_periods_near(pcm, hw, &periodos, nullptr);
+        if (err >= 0) err = snd_pcm_hw_params(pcm, hw);
+        if (err >= 0) {
+            snd_pcm_hw_params_get_period_size(hw, &periodo, nullptr);
+            snd_pcm_hw_params_get_buffer_size(hw, &tamBuffer);
+        }
+        snd_pcm_hw_params_free(hw);
+        return err;
+    }
+
+    // writei, o su equivalente si el PCM quedó con acceso mmap; si hay xrun
+    // se recupera y reintenta
+    bool copiar(const int16_t* datos, int frames) {
+        while (frames > 0) {
+            snd_pcm_sframes_t n = accesoMmap ? snd_pcm_mmap_writei(pcm, datos, snd_pcm_uframes_t(frames))
+                                             : snd_pcm_writei(pcm, datos, snd_pcm_uframes_t(frames));
+            if (n < 0) {
+                if (!recuperar(int(n))) return false;
+                continue;
+            }
+            datos += n;
+            frames -= int(n);
+            escritas += uint64_t(n);
+        }
+        actualizarAudibles();
+        return true;
+    }
+
+    // Xrun (-EPIPE) o suspensión (-ESTRPIPE): se prepara el PCM y se sigue
+    bool recuperar(int err) {
+        if (err == -EPIPE || err == -ESTRPIPE) xruns.fetch_add(1, std::memory_order_relaxed);
+        if (snd_pcm_recover(pcm, err, 1) < 0) return false;
+        return true;
+    }
+
+    void actualizarAudibles() {
+        snd_pcm_sframes_t retardo = 0;
+        if (snd_pcm_delay(pcm, &retardo) < 0 || retardo < 0) retardo = 0;
+        audibles.store(escritas > uint64_t(retardo) ? escritas - uint64_t(retardo) : 0,
+                       std::memory_order_release);
+    }
+};
+
+#endif
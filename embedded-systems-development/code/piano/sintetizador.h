@@ -0,0 +1,655 @@
+#ifndef SINTETIZADOR_H
+#define SINTETIZADOR_H
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "traza.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define FRECUENCIA_MUESTREO 48000
+#define NUM_NOTAS 25
+#define TAM_TABLA 65536
+#define MAX_PERIODO 1024
+#define GANANCIA_VOZ 0.3f
+#define MAX_BUCLE 4800                // 100 ms a 48 kHz
+#define TOLERANCIA_BUCLE_CENTS 0.1    // desafinación aceptada para cerrar el bucle
+
+// Notas de C4 a C6 en orden cromático, con las mismas frecuencias de los .dsp en piano/notes
+const char* const nombresNotas[NUM_NOTAS] = {
+    "C4", "C#4", "D4", "D#4", "E4", "F4", "F#4", "G4", "G#4", "A4", "A#4", "B4",
+    "C5", "C#5", "D5", "D#5", "E5", "F5", "F#5", "G5", "G#5", "A5", "A#5", "B5",
+    "C6"
+};
+
+const float frecuencias[NUM_NOTAS] = {
+    261.63f, 277.18f, 293.66f, 311.13f, 329.63f, 349.23f, 369.99f, 392.00f, 415.30f, 440.00f, 466.16f, 493.88f,
+    523.25f, 554.37f, 587.33f, 622.25f, 659.25f, 698.46f, 739.99f, 783.99f, 830.61f, 880.00f, 932.33f, 987.77f,
+    1046.50f
+};
+
+// Para registros y mensajes: "?" fuera de rango
+inline const char* nombreNota(int nota) { return nota >= 0 && nota < NUM_NOTAS ? nombresNotas[nota] : "?"; }
+
+inline int indiceNota(const std::string& nota) {
+    for (int i = 0; i < NUM_NOTAS; ++i)
+        if (nota == nombresNotas[i]) return i;
+    return -1;
+}
+
+// Tabla de seno de 65536 puntos, igual a la que genera Faust para os.osc
+inline const float* tablaSeno() {
+    static float tabla[TAM_TABLA];
+    static bool lista = false;
+    if (!lista) {
+        for (int i = 0; i < TAM_TABLA; ++i)
+            tabla[i] = std::sin(9.58738e-05f * float(i));
+        lista = true;
+    }
+    return tabla;
+}
+
+// La misma tabla en Q15 para la aritmética entera
+inline const int16_t* tablaSenoQ15() {
+    static int16_t tabla[TAM_TABLA];
+    static bool lista = false;
+    if (!lista) {
+        for (int i = 0; i < TAM_TABLA; ++i)
+            tabla[i] = int16_t(std::lround(std::sin(2.0 * M_PI * i / TAM_TABLA) * 32767.0));
+        lista = true;
+    }
+    return tabla;
+}
+
+// Busca el bucle más corto que contiene un número entero de ciclos de la
+// nota: con ese largo la última muestra empalma con la primera sin salto.
+// La frecuencia se corrige a ciclos * FRECUENCIA_MUESTREO / largo, que queda
+// a menos de TOLERANCIA_BUCLE_CENTS de la original (o lo más cerca posible).
+inline void elegirBucle(float frecuencia, int& largo, int& ciclos) {
+    double mejorCents = 1e9;
+    for (int l = 64; l <= MAX_BUCLE; ++l) {
+        int c = int(std::lround(double(l) * frecuencia / FRECUENCIA_MUESTREO));
+        if (c == 0) continue;
+        double cents = std::fabs(1200.0 * std::log2(double(c) * FRECUENCIA_MUESTREO / l / frecuencia));
+        if (cents < mejorCents) {
+            mejorCents = cents;
+            largo = l;
+            ciclos = c;
+            if (cents < TOLERANCIA_BUCLE_CENTS) return;
+        }
+    }
+}
+
+// Las 25 notas sintetizadas una vez en bucles que se repiten sin costura.
+// Tocar una nota es copiar y sumar muestras de su bucle.
+class CacheBucles {
+public:
+    static const CacheBucles& global() {
+        static CacheBucles cache;
+        return cache;
+    }
+
+    const float* datos(int nota) const { return muestras.data() + inicio[nota]; }
+    const int16_t* datosQ15(int nota) const { return muestrasQ15.data() + inicio[nota]; }
+    int largo(int nota) const { return largos[nota]; }
+    int ciclos(int nota) const { return ciclosNota[nota]; }
+    size_t bytes() const { return muestras.size() * sizeof(float) + muestrasQ15.size() * sizeof(int16_t); }
+
+private:
+    std::vector<float> muestras;
+    std::vector<int16_t> muestrasQ15;
+    int inicio[NUM_NOTAS];
+    int largos[NUM_NOTAS];
+    int ciclosNota[NUM_NOTAS];
+
+    CacheBucles() {
+        int total = 0;
+        for (int n = 0; n < NUM_NOTAS; ++n) {
+            elegirBucle(frecuencias[n], largos[n], ciclosNota[n]);
+            inicio[n] = total;
+            total += largos[n];
+        }
+        muestras.resize(total);
+        muestrasQ15.resize(total);
+        for (int n = 0; n < NUM_NOTAS; ++n)
+            for (int i = 0; i < largos[n]; ++i) {
+                double x = std::sin(2.0 * M_PI * ciclosNota[n] * i / largos[n]);
+                muestras[inicio[n] + i] = float(x);
+                muestrasQ15[inicio[n] + i] = int16_t(std::lround(x * 32767.0));
+            }
+    }
+};
+
+// Viva calcula cada muestra con la tabla de seno como Faust; cache reproduce
+// los bucles pre-renderizados
+enum ModoSintesis { SINTESIS_VIVA, SINTESIS_CACHE };
+
+// Flotante suma las voces en float y convierte a S16 al final, como la
+// salida de Faust; Q15 hace tabla, fase, envolvente y mezcla en enteros y
+// escribe S16 directamente, con sumas saturadas (NEON en la placa)
+enum Aritmetica { ARITMETICA_FLOTANTE, ARITMETICA_Q15 };
+
+// ADSR lineal por voz. Los tiempos son desde 0 hasta 1 (ataque y relajación)
+// o desde 1 hasta el sostenido (decaimiento); una relajación que empieza más
+// abajo termina antes.
+#define ATAQUE_MS 5.0f
+#define DECAIMIENTO_MS 80.0f
+#define NIVEL_SOSTENIDO 0.7f
+#define RELAJACION_MS 150.0f
+
+struct Envolvente {
+    float ataqueMs = ATAQUE_MS;
+    float decaimientoMs = DECAIMIENTO_MS;
+    float sostenido = NIVEL_SOSTENIDO;
+    float relajacionMs = RELAJACION_MS;
+};
+
+enum EtapaVoz { ETAPA_INACTIVA, ETAPA_ATAQUE, ETAPA_DECAIMIENTO, ETAPA_SOSTENIDO, ETAPA_RELAJACION };
+
+// Las voces son un conjunto fijo que se reparte entre las teclas. Con más
+// teclas que voces se roba una que ya suena: se corta con una relajación
+// rápida mientras la misma voz empieza la nota nueva, así el peor caso del
+// render queda acotado por la polifonía sin importar cuántas teclas haya.
+#define MAX_VOCES NUM_NOTAS
+#define POLIFONIA 12           // diez dedos y un par de relajaciones
+#define ROBO_MS 3.0f
+
+enum PoliticaRobo { ROBAR_VIEJA, ROBAR_SUAVE, ROBAR_GRAVE };
+
+const char* const nombresPolitica[] = { "vieja", "suave", "grave" };
+
+inline int indicePolitica(const std::string& nombre) {
+    for (int i = 0; i < 3; ++i)
+        if (nombre == nombresPolitica[i]) return i;
+    return -1;
+}
+
+// Estado del oscilador de una nota: fase para la síntesis viva, posición
+// dentro del bucle para la cache
+struct Oscilador {
+    int nota = -1;
+    float fase = 0.0f;
+    float incremento = 0.0f;
+    uint32_t fase32 = 0;        // la fase en Q32 para la aritmética entera
+    uint32_t incremento32 = 0;
+    int posicion = 0;
+};
+
+struct Voz {
+    EtapaVoz etapa = ETAPA_INACTIVA;
+    float nivel = 0.0f;       // ganancia de la envolvente al final de la última muestra
+    uint64_t inicio = 0;      // orden de llegada, para robar la más vieja
+    Oscilador osc;
+    // Nota robada que todavía se apaga en esta voz
+    Oscilador cola;
+    float nivelCola = 0.0f;
+    float pasoCola = 0.0f;
+};
+
+// Genera las 25 notas dentro del mismo proceso con un conjunto fijo de voces
+class Sintetizador {
+public:
+    Sintetizador() : tabla(tablaSeno()), tablaQ15(tablaSenoQ15()) {
+        fijarEnvolvente(Envolvente{});
+        fijarPolifonia(POLIFONIA, ROBAR_VIEJA);
+    }
+
+    void fijarEnvolvente(const Envolvente& e) {
+        env = e;
+        pasoAtaque = pasoPorMuestra(1.0f, e.ataqueMs);
+        pasoDecaimiento = pasoPorMuestra(1.0f - e.sostenido, e.decaimientoMs);
+        pasoRelajacion = pasoPorMuestra(1.0f, e.relajacionMs);
+    }
+
+    // Cuántas voces hay (1 a MAX_VOCES) y a cuál se le quita la nota cuando
+    // no queda ninguna libre. Corta lo que suena: llamarla al arrancar.
+    void fijarPolifonia(int voces, PoliticaRobo p) {
+        polifonia = std::max(1, std::min(voces, MAX_VOCES));
+        limite = polifonia;
+        politica = p;
+        cortarTodas();
+    }
+
+    int polifoniaActual() const { return polifonia; }
+
+    // Tope de voces sonando a la vez, sin rehacer el conjunto: se puede
+    // cambiar mientras suena. Las que sobran se eligen como en un robo y se
+    // apagan en ROBO_MS, pero se cuentan aparte (vocesQuitadas).
+    void limitarVoces(int n) {
+        limite = std::max(1, std::min(n, polifonia));
+        quitarSobrantes();
+    }
+
+    int limiteVoces() const { return limite; }
+    PoliticaRobo politicaActual() const { return politica; }
+
+    // Una voz que todavía suena (por ejemplo en relajación) sigue con su fase
+    // y ataca desde el nivel en que está, así no hay salto
+    void notaOn(int nota) {
+        if (nota < 0 || nota >= NUM_NOTAS) return;
+        int i = vozDeNota[nota];
+        if (i < 0) {
+            i = numLibres > 0 && numActivas < limite ? tomarLibre() : robar();
+            Voz& v = voces[i];
+            v.osc.nota = nota;
+            v.osc.fase = 0.0f;
+            v.osc.fase32 = 0;
+            v.osc.posicion = 0;
+            v.osc.incremento = frecuencias[nota] / float(FRECUENCIA_MUESTREO);
+            v.osc.incremento32 = uint32_t(std::llround(double(frecuencias[nota]) / FRECUENCIA_MUESTREO * 4294967296.0));
+            v.nivel = 0.0f;
+            vozDeNota[nota] = i;
+        }
+        voces[i].etapa = ETAPA_ATAQUE;
+        voces[i].inicio = ++llegadas;
+        TRAZA_INSTANTE(TRAZA_VOZ, nota);
+    }
+
+    // Cambia de modo sin cortar las voces que suenan: la posición en el
+    // bucle y la fase se convierten una en la otra
+    void fijarModo(ModoSintesis m) {
+        if (m == modo) return;
+        if (m == SINTESIS_CACHE && !cache) cache = &CacheBucles::global();
+        for (int k = 0; k < numActivas; ++k) {
+            Voz& v = voces[activas[k]];
+            convertir(v.osc, m);
+            if (v.nivelCola > 0.0f) convertir(v.cola, m);
+        }
+        modo = m;
+    }
+
+    ModoSintesis modoActual() const { return modo; }
+
+    // Cambia de aritmética sin cortar las voces: la fase pasa de float a Q32
+    void fijarAritmetica(Aritmetica a) {
+        if (a == aritmetica) return;
+        for (int k = 0; k < numActivas; ++k) {
+            Voz& v = voces[activas[k]];
+            pasarFase(v.osc, a);
+            pasarFase(v.cola, a);
+        }
+        aritmetica = a;
+    }
+
+    Aritmetica aritmeticaActual() const { return aritmetica; }
+
+    // La voz entra en relajación y se libera sola cuando llega a cero
+    void notaOff(int nota) {
+        if (nota < 0 || nota >= NUM_NOTAS) return;
+        int i = vozDeNota[nota];
+        if (i >= 0 && voces[i].etapa != ETAPA_INACTIVA) voces[i].etapa = ETAPA_RELAJACION;
+    }
+
+    void apagarTodas() {
+        for (int k = 0; k < numActivas; ++k) {
+            Voz& v = voces[activas[k]];
+            if (v.etapa != ETAPA_INACTIVA) v.etapa = ETAPA_RELAJACION;
+        }
+    }
+
+    // Silencio inmediato, sin relajación
+    void cortarTodas() {
+        for (auto& v : voces) {
+            v.etapa = ETAPA_INACTIVA;
+            v.nivel = 0.0f;
+            v.nivelCola = 0.0f;
+        }
+        for (int& v : vozDeNota) v = -1;
+        numActivas = 0;
+        numLibres = polifonia;
+        for (int i = 0; i < polifonia; ++i) libres[i] = polifonia - 1 - i;
+    }
+
+    int vocesActivas() const { return numActivas; }
+
+    // La nota tiene voz (suena o se está soltando)
+    bool sonando(int nota) const { return nota >= 0 && nota < NUM_NOTAS && vozDeNota[nota] >= 0; }
+
+    // Notas a las que se les quitó la voz desde que se creó el sintetizador
+    uint64_t robos() const { return robadas; }
+
+    // Voces apagadas por limitarVoces
+    uint64_t vocesQuitadas() const { return quitadas; }
+
+    // Escribe "frames" muestras mono S16 en salida (frames <= MAX_PERIODO)
+    void render(int16_t* salida, int frames) {
+        if (sobran) quitarSobrantes();
+        if (aritmetica == ARITMETICA_Q15) {
+            // Cada voz se suma saturando directo en la salida
+            const float escala = GANANCIA_VOZ * 2147483648.0f;
+            std::fill(salida, salida + frames, int16_t(0));
+            recorrerVoces(frames, [&](int desde, float inicio, float paso, int n) {
+                sumarRampaQ15(salida + desde, ondaQ15 + desde, int32_t(std::lrint(inicio * escala)),
+                              int32_t(std::lrint(paso * escala)), n);
+            });
+            return;
+        }
+
+        std::fill(mezcla, mezcla + frames, 0.0f);
+        recorrerVoces(frames, [&](int desde, float inicio, float paso, int n) {
+            sumarRampa(mezcla + desde, onda + desde, inicio, paso, n);
+        });
+        for (int i = 0; i < frames; ++i) {
+            float m = mezcla[i] * GANANCIA_VOZ;
+            m = std::max(-1.0f, std::min(1.0f, m));
+            salida[i] = int16_t(m * 32767.0f);
+        }
+    }
+
+private:
+    const float* tabla;
+    const int16_t* tablaQ15;
+    const CacheBucles* cache = nullptr;
+    ModoSintesis modo = SINTESIS_VIVA;
+    Aritmetica aritmetica = ARITMETICA_FLOTANTE;
+    Envolvente env;
+    float pasoAtaque = 1.0f, pasoDecaimiento = 1.0f, pasoRelajacion = 1.0f;
+
+    // Voces libres en una pila y activas en una lista compacta: tomar y
+    // soltar una voz es O(1) y el render solo recorre las que suenan
+    Voz voces[MAX_VOCES];
+    int libres[MAX_VOCES];
+    int numLibres = 0;
+    int activas[MAX_VOCES];
+    int numActivas = 0;
+    int vozDeNota[NUM_NOTAS];
+    int polifonia = POLIFONIA;
+    int limite = POLIFONIA;
+    bool sobran = false;        // quedaron voces de más esperando que se libere su cola
+    PoliticaRobo politica = ROBAR_VIEJA;
+    uint64_t llegadas = 0;
+    uint64_t robadas = 0;
+    uint64_t quitadas = 0;
+
+    float onda[MAX_PERIODO];    // oscilador de la voz actual, antes de la envolvente
+    int16_t ondaQ15[MAX_PERIODO];
+    float mezcla[MAX_PERIODO];
+
+    static float pasoPorMuestra(float recorrido, float ms) {
+        float muestras = ms * FRECUENCIA_MUESTREO / 1000.0f;
+        return muestras >= 1.0f ? recorrido / muestras : recorrido;
+    }
+
+    int tomarLibre() {
+        int i = libres[--numLibres];
+        activas[numActivas++] = i;
+        return i;
+    }
+
+    void liberar(int k) {
+        int i = activas[k];
+        Voz& v = voces[i];
+        if (v.osc.nota >= 0 && vozDeNota[v.osc.nota] == i) vozDeNota[v.osc.nota] = -1;
+        activas[k] = activas[--numActivas];
+        libres[numLibres++] = i;
+    }
+
+    // Una nota que llega sin voz libre le quita la suya a otra
+    int robar() {
+        int i = elegirVoz(false);
+        apagarEnCola(i);
+        ++robadas;
+        return i;
+    }
+
+    // Apaga las voces que pasan del límite. Solo se quita una voz que puede
+    // tomar la cola: si la que apaga la de un robo se quitara ahora, una de
+    // las dos se cortaría de golpe. Esas quedan para el próximo render, y la
+    // cola se termina en ROBO_MS.
+    void quitarSobrantes() {
+        int sonando = 0;
+        for (int k = 0; k < numActivas; ++k)
+            if (voces[activas[k]].etapa != ETAPA_INACTIVA) ++sonando;
+        for (; sonando > limite; --sonando) {
+            int i = elegirVoz(true);
+            if (i < 0) break;
+            apagarEnCola(i);
+            voces[i].etapa = ETAPA_INACTIVA;
+            voces[i].nivel = 0.0f;
+            ++quitadas;
+        }
+        sobran = sonando > limite;
+    }
+
+    // Elige la voz a robar entre las activas (a lo sumo "polifonia"). Las que
+    // todavía apagan la cola de un robo y además suenan van al final: la cola
+    // se perdería de golpe. Después, las que ya están en relajación (o solo
+    // terminan de apagar una cola) van primero: esa tecla ya se soltó. Con
+    // paraQuitar (limitarVoces) solo cuentan las que suenan y tienen la cola
+    // libre; si no hay ninguna devuelve -1.
+    int elegirVoz(bool paraQuitar) {
+        int mejor = -1;
+        for (int k = 0; k < numActivas; ++k) {
+            int i = activas[k];
+            const Voz& a = voces[i];
+            if (paraQuitar && (a.etapa == ETAPA_INACTIVA || perderiaCola(a))) continue;
+            if (mejor < 0) {
+                mejor = i;
+                continue;
+            }
+            const Voz& b = voces[mejor];
+            bool colaA = perderiaCola(a), colaB = perderiaCola(b);
+            if (colaA != colaB) {
+                if (colaB) mejor = i;
+                continue;
+            }
+            bool sueltaA = a.etapa == ETAPA_RELAJACION || a.etapa == ETAPA_INACTIVA;
+            bool sueltaB = b.etapa == ETAPA_RELAJACION || b.etapa == ETAPA_INACTIVA;
+            if (sueltaA != sueltaB) {
+                if (sueltaA) mejor = i;
+                continue;
+            }
+            bool antes = politica == ROBAR_SUAVE ? a.nivel < b.nivel
+                       : politica == ROBAR_GRAVE ? a.osc.nota < b.osc.nota
+                       : a.inicio < b.inicio;
+            if (antes) mejor = i;
+        }
+        return mejor;
+    }
+
+    static bool perderiaCola(const Voz& v) { return v.nivelCola > 0.0f && v.etapa != ETAPA_INACTIVA && v.nivel > 0.0f; }
+
+    // La nota vieja de la voz i sigue sonando como cola y baja a cero en
+    // ROBO_MS; la voz queda libre para otra nota. Si todas las voces tenían
+    // una cola (más de "polifonia" notas en ROBO_MS) queda la más fuerte de
+    // las dos y se corta la otra, el salto más chico posible.
+    void apagarEnCola(int i) {
+        Voz& v = voces[i];
+        if (v.osc.nota >= 0 && vozDeNota[v.osc.nota] == i) vozDeNota[v.osc.nota] = -1;
+        if (v.etapa != ETAPA_INACTIVA && v.nivel > v.nivelCola) {
+            v.cola = v.osc;
+            v.nivelCola = v.nivel;
+            v.pasoCola = pasoPorMuestra(v.nivel, ROBO_MS);
+        }
+    }
+
+    void convertir(Oscilador& o, ModoSintesis m) {
+        int largo = cache->largo(o.nota), ciclos = cache->ciclos(o.nota);
+        if (m == SINTESIS_CACHE) {
+            double fase = aritmetica == ARITMETICA_Q15 ? o.fase32 / 4294967296.0 : o.fase;
+            o.posicion = int(fase * largo / ciclos) % largo;
+        } else {
+            double c = double(o.posicion) * ciclos / largo;
+            o.fase = float(c - std::floor(c));
+            o.fase32 = uint32_t(o.fase * 4294967296.0);
+        }
+    }
+
+    static void pasarFase(Oscilador& o, Aritmetica a) {
+        if (a == ARITMETICA_Q15) o.fase32 = uint32_t(double(o.fase) * 4294967296.0);
+        else o.fase = float(o.fase32 / 4294967296.0);
+    }
+
+    void generar(Oscilador& o, int frames) {
+        if (aritmetica == ARITMETICA_Q15) {
+            if (modo == SINTESIS_CACHE) copiarBucleQ15(o, frames);
+            else oscilarQ15(o, frames);
+        } else {
+            if (modo == SINTESIS_CACHE) copiarBucle(o, frames);
+            else oscilar(o, frames);
+        }
+    }
+
+    // Recorre las voces que suenan: la cola de la nota robada, el oscilador y
+    // la envolvente. "sumar(desde, inicio, paso, n)" aplica una rampa de
+    // ganancia a la onda recién generada y la suma a la mezcla.
+    template <class Sumar>
+    void recorrerVoces(int frames, Sumar sumar) {
+        for (int k = 0; k < numActivas;) {
+            Voz& v = voces[activas[k]];
+            if (v.nivelCola > 0.0f) apagarCola(v, frames, sumar);
+            if (v.etapa != ETAPA_INACTIVA) {
+                generar(v.osc, frames);
+                aplicarEnvolvente(v, frames, sumar);
+            }
+            if (v.etapa == ETAPA_INACTIVA && v.nivelCola <= 0.0f) liberar(k);
+            else ++k;
+        }
+    }
+
+    void oscilar(Oscilador& o, int frames) {
+        float fase = o.fase;
+        for (int i = 0; i < frames; ++i) {
+            fase = o.incremento + (fase - std::floor(o.incremento + fase));
+            int idx = std::max(0, std::min(int(65536.0f * fase), TAM_TABLA - 1));
+            onda[i] = tabla[idx];
+        }
+        o.fase = fase;
+    }
+
+    // La fase Q32 da la vuelta sola; sus 16 bits altos son el índice
+    void oscilarQ15(Oscilador& o, int frames) {
+        uint32_t fase = o.fase32;
+        for (int i = 0; i < frames; ++i) {
+            fase += o.incremento32;
+            ondaQ15[i] = tablaQ15[fase >> 16];
+        }
+        o.fase32 = fase;
+    }
+
+    void copiarBucleQ15(Oscilador& o, int frames) {
+        copiarTramos(cache->datosQ15(o.nota), cache->largo(o.nota), o.posicion, ondaQ15, frames);
+    }
+
+    void copiarBucle(Oscilador& o, int frames) {
+        copiarTramos(cache->datos(o.nota), cache->largo(o.nota), o.posicion, onda, frames);
+    }
+
+    // Copia en tramos contiguos hasta el final del bucle, y vuelve al inicio
+    template <class T>
+    static void copiarTramos(const T* bucle, int largo, int& posicion, T* destino, int frames) {
+        int pos = posicion;
+        int hecho = 0;
+        while (hecho < frames) {
+            int tramo = std::min(frames - hecho, largo - pos);
+            std::copy(bucle + pos, bucle + pos + tramo, destino + hecho);
+            hecho += tramo;
+            pos += tramo;
+            if (pos == largo) pos = 0;
+        }
+        posicion = pos;
+    }
+
+    // Relajación rápida de la nota robada; como en la envolvente, el último
+    // paso cae justo en cero
+    template <class Sumar>
+    void apagarCola(Voz& v, int frames, Sumar& sumar) {
+        int restantes = std::max(1, int(std::ceil(v.nivelCola / v.pasoCola)));
+        int n = std::min(frames, restantes);
+        generar(v.cola, n);
+        if (n == restantes) {
+            sumar(0, v.nivelCola, -v.nivelCola / float(n), n);
+            v.nivelCola = 0.0f;
+        } else {
+            sumar(0, v.nivelCola, -v.pasoCola, n);
+            v.nivelCola -= v.pasoCola * float(n);
+        }
+    }
+
+    // Multiplica y suma con una rampa lineal: sin dependencias entre
+    // muestras, así el compilador lo vectoriza
+    static void sumarRampa(float* destino, const float* origen, float inicio, float paso, int n) {
+        for (int i = 0; i < n; ++i) destino[i] += origen[i] * (inicio + paso * float(i + 1));
+    }
+
+    // Lo mismo en enteros: la ganancia va en Q31 (ya con GANANCIA_VOZ) para
+    // que las rampas largas no pierdan pasos, y se multiplica con sus 16 bits
+    // altos. La suma satura en vez de dar la vuelta.
+    static void sumarRampaQ15(int16_t* destino, const int16_t* origen, int32_t inicio, int32_t paso, int n) {
+        int i = 0;
+#if defined(__ARM_NEON)
+        // vqdmulh: (a * b * 2) >> 16, el producto Q15 x Q15 en un paso
+        const int32_t base[4] = { paso, 2 * paso, 3 * paso, 4 * paso };
+        int32x4_t g = vaddq_s32(vdupq_n_s32(inicio), vld1q_s32(base));
+        int32x4_t cuatro = vdupq_n_s32(4 * paso);
+        for (; i + 8 <= n; i += 8) {
+            int32x4_t g2 = vaddq_s32(g, cuatro);
+            int16x8_t ganancia = vcombine_s16(vshrn_n_s32(g, 16), vshrn_n_s32(g2, 16));
+            int16x8_t voz = vqdmulhq_s16(vld1q_s16(origen + i), ganancia);
+            vst1q_s16(destino + i, vqaddq_s16(vld1q_s16(destino + i), voz));
+            g = vaddq_s32(g2, cuatro);
+        }
+#endif
+        for (; i < n; ++i) {
+            int32_t ganancia = (inicio + paso * (i + 1)) >> 16;
+            int32_t m = destino[i] + ((int32_t(origen[i]) * ganancia) >> 15);
+            destino[i] = int16_t(std::max(-32768, std::min(32767, m)));
+        }
+    }
+
+    // La envolvente se aplica por tramos: cada tramo es una sola etapa, con
+    // ganancia constante o una rampa, y se cambia de etapa en la muestra justa
+    template <class Sumar>
+    void aplicarEnvolvente(Voz& v, int frames, Sumar& sumar) {
+        int i = 0;
+        while (i < frames && v.etapa != ETAPA_INACTIVA) {
+            if (v.etapa == ETAPA_SOSTENIDO) {
+                v.nivel = env.sostenido;
+                sumar(i, v.nivel, 0.0f, frames - i);
+                return;
+            }
+
+            float paso, objetivo;
+            EtapaVoz siguiente;
+            if (v.etapa == ETAPA_ATAQUE) {
+                paso = pasoAtaque;
+                objetivo = 1.0f;
+                siguiente = ETAPA_DECAIMIENTO;
+            } else if (v.etapa == ETAPA_DECAIMIENTO) {
+                paso = -pasoDecaimiento;
+                objetivo = env.sostenido;
+                siguiente = ETAPA_SOSTENIDO;
+            } else {
+                paso = -pasoRelajacion;
+                objetivo = 0.0f;
+                siguiente = ETAPA_INACTIVA;
+            }
+
+            int restantes = paso != 0.0f ? int(std::ceil((objetivo - v.nivel) / paso)) : 0;
+            if (restantes <= 0) {
+                v.nivel = objetivo;
+                v.etapa = siguiente;
+                continue;
+            }
+
+            int n = std::min(frames - i, restantes);
+            if (n == restantes) {
+                // El último paso cae justo en el objetivo
+                paso = (objetivo - v.nivel) / float(n);
+                sumar(i, v.nivel, paso, n);
+                v.nivel = objetivo;
+                v.etapa = siguiente;
+            } else {
+                sumar(i, v.nivel, paso, n);
+                v.nivel += paso * float(n);
+            }
+            i += n;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef TIEMPO_REAL_H
+#define TIEMPO_REAL_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// El T113 tiene dos núcleos A7: el audio va solo en uno y el escaneo de
+// teclas, los LEDs y la pantalla en el otro
+#define PRIORIDAD_AUDIO 80
+#define PRIORIDAD_ESCANEO 70
+#define CPU_AUDIO 1
+#define CPU_ESCANEO 0
+#define PILA_PREFAULT (256 * 1024)
+
+struct ConfigTiempoReal {
+    bool activo = true;
+    int prioridadAudio = PRIORIDAD_AUDIO;
+    int prioridadEscaneo = PRIORIDAD_ESCANEO;
+    int cpuAudio = CPU_AUDIO;
+    int cpuEscaneo = CPU_ESCANEO;
+};
+
+// Deja toda la memoria del proceso fija en RAM y evita que malloc devuelva o
+// pida memoria al sistema después, para que no haya fallos de página en el
+// camino del audio. Se llama una vez al arrancar, antes de crear los hilos.
+inline bool bloquearMemoria() {
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        perror("mlockall");
+        return false;
+    }
+    return true;
+}
+
+// Toca la pila del hilo actual para que sus páginas ya estén en RAM
+inline void prefaultPila(size_t bytes = PILA_PREFAULT) {
+    volatile char* pila = static_cast<volatile char*>(__builtin_alloca(bytes));
+    for (size_t i = 0; i < bytes; i += 4096) pila[i] = 0;
+}
+
+// SCHED_FIFO con la prioridad dada en el hilo actual, fijo en un núcleo.
+// Con prioridad 0 vuelve a SCHED_OTHER. cpu < 0 no cambia la afinidad.
+inline bool fijarTiempoReal(int prioridad, int cpu, const char* nombre) {
+    bool ok = true;
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err) {
+            fprintf(stderr, "%s: no se pudo fijar el núcleo %d: %s\n", nombre, cpu, strerror(err));
+            ok = false;
+        }
+    }
+
+    sched_param param{};
+    param.sched_priority = prioridad;
+    int err = pthread_setschedparam(pthread_self(), prioridad > 0 ? SCHED_FIFO : SCHED_OTHER, &param);
+    if (err) {
+        fprintf(stderr, "%s: no se pudo poner SCHED_FIFO %d: %s\n", nombre, prioridad, strerror(err));
+        ok = false;
+    }
+    return ok;
+}
+
+// Lee --sin-rt, --prio-audio N, --prio-escaneo N, --cpu-audio N y --cpu-escaneo N
+inline void leerConfigTiempoReal(int argc, char** argv, ConfigTiempoReal& config) {
+    for (int i = 1; i < argc; ++i) {
+        bool hayValor = i + 1 < argc;
+        if (!strcmp(argv[i], "--sin-rt")) config.activo = false;
+        else if (!strcmp(argv[i], "--prio-audio") && hayValor) config.prioridadAudio = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--prio-escaneo") && hayValor) config.prioridadEscaneo = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--cpu-audio") && hayValor) config.cpuAudio = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--cpu-escaneo") && hayValor) config.cpuEscaneo = atoi(argv[++i]);
+    }
+}
+
+#endif
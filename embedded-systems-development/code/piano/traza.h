@@ -0,0 +1,269 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <cstdint>
+
+// Trazas para ver quién llegó tarde cuando una nota suena tarde: el
+// escaneo, la cola, el periodo de audio o ALSA. Con -DTRAZAS cada punto
+// TRAZA_* escribe 16 bytes en el anillo de su hilo (el contador del
+// procesador, sin bloqueos ni llamadas al sistema). Los anillos se pisan: son
+// una caja negra con los últimos TAM_ANILLO_TRAZA eventos de cada hilo.
+// Trazas::volcar() (o pedirVolcado() desde cualquier hilo, y lo hace un
+// hilo de prioridad baja) los escribe en el formato JSON de Chrome, que
+// abren chrome://tracing y ui.perfetto.dev. La cola se dibuja como flechas
+// del evento encolado al sacado.
+//
+// Sin TRAZAS las macros no generan código.
+
+enum TipoTraza : uint8_t {
+    TRAZA_ESCANEO,       // duración: un escaneo de la matriz
+    TRAZA_TECLA,         // instante: flanco de tecla, dato = nota + 32 si se apretó
+    TRAZA_ENCOLADO,      // flecha que sale: evento puesto en la cola de audio
+    TRAZA_SACADO,        // flecha que llega: el audio aplica el evento
+    TRAZA_VOZ,           // instante: una voz empieza, dato = nota
+    TRAZA_PERIODO,       // duración: render de un periodo
+    TRAZA_ALSA,          // duración: reservar o confirmar en ALSA (puede esperar)
+    NUM_TIPOS_TRAZA
+};
+
+#ifdef TRAZAS
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define MAX_HILOS_TRAZA 8
+#define TAM_ANILLO_TRAZA 16384         // potencia de 2; 256 KB por hilo
+#define INTERVALO_TRAZAS_MS 100
+#define NICE_TRAZAS 19
+#define PREFIJO_TRAZAS "/tmp/piano-traza"
+
+const char* const nombresTraza[NUM_TIPOS_TRAZA] = { "escaneo", "tecla", "encolado", "sacado", "voz", "periodo", "alsa" };
+
+enum FaseTraza : uint8_t { FASE_INICIO = 'B', FASE_FIN = 'E', FASE_INSTANTE = 'i', FASE_SALE = 's', FASE_LLEGA = 'f' };
+
+// Contador del procesador cuando se puede leer sin el kernel: TSC en x86 y
+// el contador virtual del temporizador genérico en ARM (el A7 lo tiene y
+// Linux lo deja leer, es lo que usa el vDSO). Si no, CLOCK_MONOTONIC. Se
+// pasa a ns al volcar, con dos lecturas de los dos relojes.
+inline uint64_t ticksTraza() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#elif defined(__ARM_ARCH_7A__)
+    uint32_t bajo, alto;
+    asm volatile("mrrc p15, 1, %0, %1, c14" : "=r"(bajo), "=r"(alto));
+    return uint64_t(alto) << 32 | bajo;
+#else
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return uint64_t(t.tv_sec) * 1000000000ull + uint64_t(t.tv_nsec);
+#endif
+}
+
+inline uint64_t nsTraza() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return uint64_t(t.tv_sec) * 1000000000ull + uint64_t(t.tv_nsec);
+}
+
+struct EventoTraza {
+    uint64_t ticks;
+    uint8_t tipo;
+    uint8_t fase;
+    uint16_t reservado;
+    int32_t dato;
+};
+
+class Trazas {
+public:
+    static Trazas& global() {
+        static Trazas t;
+        return t;
+    }
+
+    void anotar(TipoTraza tipo, FaseTraza fase, int32_t dato) {
+        Anillo* a = anilloDelHilo();
+        if (!a) return;
+        uint64_t i = a->escritos.load(std::memory_order_relaxed);
+        a->eventos[i & (TAM_ANILLO_TRAZA - 1)] = {ticksTraza(), tipo, fase, 0, dato};
+        a->escritos.store(i + 1, std::memory_order_release);
+    }
+
+    // Nombre del hilo en el visor; llamar desde el hilo
+    void nombrarHilo(const char* nombre) {
+        Anillo* a = anilloDelHilo();
+        if (a) a->nombre.store(nombre, std::memory_order_relaxed);
+    }
+
+    // Desde cualquier hilo (o un manejador de señal): el volcado lo hace el
+    // hilo de fondo, si se inició con iniciar()
+    void pedirVolcado() { pedido.store(true, std::memory_order_relaxed); }
+
+    bool iniciar(const char* prefijo = PREFIJO_TRAZAS) {
+        if (corriendo) return true;
+        snprintf(this->prefijo, sizeof(this->prefijo), "%s", prefijo);
+        corriendo = true;
+        hilo = std::thread(&Trazas::bucle, this);
+        return true;
+    }
+
+    void detener() {
+        if (!corriendo) return;
+        corriendo = false;
+        hilo.join();
+    }
+
+    // Copia lo que tienen los anillos sin parar a quien escribe: lo que se
+    // pisó mientras se copiaba se descarta
+    bool volcar(const char* ruta) {
+        FILE* f = fopen(ruta, "w");
+        if (!f) {
+            perror(ruta);
+            return false;
+        }
+        // ns = ns0 + (ticks - ticks0) * escala, medido desde que se creó Trazas
+        uint64_t ticks1 = ticksTraza(), ns1 = nsTraza();
+        double escala = ticks1 > ticks0 ? double(ns1 - ns0) / double(ticks1 - ticks0) : 1.0;
+        auto aNs = [&](uint64_t ticks) { return double(ns0) + (double(ticks) - double(ticks0)) * escala; };
+
+        fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+        bool primero = true;
+        auto separar = [&]() {
+            if (!primero) fprintf(f, ",\n");
+            primero = false;
+        };
+        std::vector<EventoTraza> copia(TAM_ANILLO_TRAZA);
+        for (int h = 0; h < MAX_HILOS_TRAZA; ++h) {
+            Anillo& a = anillos[h];
+            if (!a.usado.load(std::memory_order_acquire)) continue;
+            separar();
+            const char* nombre = a.nombre.load(std::memory_order_relaxed);
+            fprintf(f, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}", h,
+                    nombre ? nombre : "hilo");
+
+            uint64_t fin = a.escritos.load(std::memory_order_acquire);
+            uint64_t inicio = fin > TAM_ANILLO_TRAZA ? fin - TAM_ANILLO_TRAZA : 0;
+            for (uint64_t i = inicio; i < fin; ++i) copia[i - inicio] = a.eventos[i & (TAM_ANILLO_TRAZA - 1)];
+            uint64_t despues = a.escritos.load(std::memory_order_acquire);
+            uint64_t pisados = despues > TAM_ANILLO_TRAZA ? despues - TAM_ANILLO_TRAZA : 0;
+            // Un fin sin su inicio confunde al visor: se empieza en un inicio
+            // o en un evento suelto
+            uint64_t desde = std::max(inicio, pisados);
+            int abiertos = 0;
+            for (uint64_t i = desde; i < fin; ++i) {
+                const EventoTraza& e = copia[i - inicio];
+                if (e.fase == FASE_FIN && abiertos == 0) continue;
+                abiertos += e.fase == FASE_INICIO ? 1 : e.fase == FASE_FIN ? -1 : 0;
+                separar();
+                escribirEvento(f, e, aNs(e.ticks), h);
+            }
+        }
+        fprintf(f, "\n]}\n");
+        bool ok = !ferror(f);
+        fclose(f);
+        return ok;
+    }
+
+    uint64_t volcados() const { return numVolcados.load(std::memory_order_relaxed); }
+
+private:
+    struct Anillo {
+        std::atomic<bool> usado{false};
+        std::atomic<const char*> nombre{nullptr};
+        std::atomic<uint64_t> escritos{0};
+        EventoTraza eventos[TAM_ANILLO_TRAZA];
+    };
+
+    Anillo anillos[MAX_HILOS_TRAZA];
+    std::atomic<bool> pedido{false};
+    std::atomic<bool> corriendo{false};
+    std::atomic<uint64_t> numVolcados{0};
+    std::thread hilo;
+    char prefijo[200] = PREFIJO_TRAZAS;
+    uint64_t ticks0 = ticksTraza();
+    uint64_t ns0 = nsTraza();
+
+    Anillo* anilloDelHilo() {
+        thread_local Anillo* propio = nullptr;
+        thread_local bool buscado = false;
+        if (!buscado) {
+            buscado = true;
+            for (int i = 0; i < MAX_HILOS_TRAZA; ++i) {
+                bool libre = false;
+                if (anillos[i].usado.compare_exchange_strong(libre, true)) {
+                    propio = &anillos[i];
+                    break;
+                }
+            }
+        }
+        return propio;
+    }
+
+    static void escribirEvento(FILE* f, const EventoTraza& e, double ns, int hilo) {
+        double us = ns / 1000.0;
+        const char* nombre = e.tipo < NUM_TIPOS_TRAZA ? nombresTraza[e.tipo] : "?";
+        fprintf(f, "{\"name\": \"%s\", \"cat\": \"piano\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": %d", nombre, e.fase, us, hilo);
+        if (e.fase == FASE_INSTANTE) fprintf(f, ", \"s\": \"t\"");
+        // La flecha va de la tecla encolada al periodo que la aplica; el id
+        // es la nota más la hora del escaneo que la vio
+        if (e.fase == FASE_SALE || e.fase == FASE_LLEGA) fprintf(f, ", \"id\": %d, \"bp\": \"e\"", e.dato);
+        if (e.tipo == TRAZA_TECLA) fprintf(f, ", \"args\": {\"nota\": %d, \"apretada\": %d}", e.dato & 31, e.dato >> 5 & 1);
+        else if (e.tipo == TRAZA_VOZ) fprintf(f, ", \"args\": {\"nota\": %d}", e.dato);
+        fprintf(f, "}");
+    }
+
+    void bucle() {
+        sched_param normal{};
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+        setpriority(PRIO_PROCESS, pid_t(syscall(SYS_gettid)), NICE_TRAZAS);
+        while (corriendo) {
+            usleep(INTERVALO_TRAZAS_MS * 1000);
+            if (!pedido.exchange(false, std::memory_order_relaxed)) continue;
+            char ruta[256];
+            snprintf(ruta, sizeof(ruta), "%s-%llu.json", prefijo, (unsigned long long)numVolcados.load() + 1);
+            if (volcar(ruta)) {
+                numVolcados.fetch_add(1, std::memory_order_relaxed);
+                fprintf(stderr, "Trazas en %s\n", ruta);
+            }
+        }
+    }
+};
+
+// Id de la flecha de un evento de teclado: igual al encolar y al sacar
+inline int32_t idFlechaTraza(uint64_t ns, int nota) { return int32_t(uint32_t(ns / 1000) * 32u + uint32_t(nota & 31)); }
+
+#define TRAZA_INICIO(tipo) Trazas::global().anotar(tipo, FASE_INICIO, 0)
+#define TRAZA_FIN(tipo) Trazas::global().anotar(tipo, FASE_FIN, 0)
+#define TRAZA_INSTANTE(tipo, dato) Trazas::global().anotar(tipo, FASE_INSTANTE, int32_t(dato))
+#define TRAZA_SALE(tipo, id) Trazas::global().anotar(tipo, FASE_SALE, id)
+#define TRAZA_LLEGA(tipo, id) Trazas::global().anotar(tipo, FASE_LLEGA, id)
+#define TRAZA_NOMBRE_HILO(nombre) Trazas::global().nombrarHilo(nombre)
+
+#else
+
+#define TRAZA_INICIO(tipo) ((void)0)
+#define TRAZA_FIN(tipo) ((void)0)
+#define TRAZA_INSTANTE(tipo, dato) ((void)0)
+#define TRAZA_SALE(tipo, id) ((void)0)
+#define TRAZA_LLEGA(tipo, id) ((void)0)
+#define TRAZA_NOMBRE_HILO(nombre) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "metricas.h"
+
+// Muestra por la consola serie las métricas de main_menu (piano/metricas.h):
+// se conecta al socket, lee el texto y lo imprime. Con --filtro solo las
+// líneas que contienen ese texto (los comentarios HELP/TYPE se omiten); con
+// --cada N repite cada N segundos.
+//
+// Uso: ./ver_metricas [--socket ruta] [--filtro texto] [--cada N]
+
+bool leerMetricas(const char* ruta, std::string& texto) {
+    sockaddr_un dir{};
+    dir.sun_family = AF_UNIX;
+    strncpy(dir.sun_path, ruta, sizeof(dir.sun_path) - 1);
+    int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s < 0) return false;
+    if (connect(s, reinterpret_cast<sockaddr*>(&dir), sizeof(dir)) < 0) {
+        close(s);
+        return false;
+    }
+    // Sin pedido el servidor contesta solo el texto
+    shutdown(s, SHUT_WR);
+    texto.clear();
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(s, buffer, sizeof(buffer))) > 0) texto.append(buffer, size_t(n));
+    close(s);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* ruta = RUTA_METRICAS;
+    const char* filtro = nullptr;
+    int cada = 0;
+    for (int i = 1; i < argc; ++i) {
+        bool hayValor = i + 1 < argc;
+        if (!strcmp(argv[i], "--socket") && hayValor) ruta = argv[++i];
+        else if (!strcmp(argv[i], "--filtro") && hayValor) filtro = argv[++i];
+        else if (!strcmp(argv[i], "--cada") && hayValor) cada = atoi(argv[++i]);
+    }
+
+    std::string texto;
+    do {
+        if (!leerMetricas(ruta, texto)) {
+            perror(ruta);
+            return 1;
+        }
+        size_t inicio = 0;
+        while (inicio < texto.size()) {
+            size_t fin = texto.find('\n', inicio);
+            if (fin == std::string::npos) fin = texto.size();
+            std::string linea = texto.substr(inicio, fin - inicio);
+            inicio = fin + 1;
+            if (filtro && (linea[0] == '#' || linea.find(filtro) == std::string::npos)) continue;
+            printf("%s\n", linea.c_str());
+        }
+        if (cada > 0) {
+            printf("\n");
+            fflush(stdout);
+            sleep(unsigned(cada));
+        }
+    } while (cada > 0);
+    return 0;
+}
@@ -0,0 +1,235 @@
+#ifndef VIGILANTE_RT_H
+#define VIGILANTE_RT_H
+
+// Vigilante de tiempo real para depurar: con -DVIGILAR_RT, todo lo que pase
+// dentro de una ZonaTiempoReal (el render de cada periodo en MotorAudio y en
+// renderizar) no puede pedir ni liberar memoria, tomar un mutex, esperar una
+// condición o un semáforo, dormir, ni hacer E/S. Cada violación se cuenta y
+// se informa por stderr con su backtrace (las primeras MAX_INFORMES_RT;
+// compilar con -rdynamic para ver los nombres). Con VIGILAR_RT_ABORTAR=1 en
+// el entorno la primera violación aborta, para verla en gdb.
+//
+// Se interceptan malloc y compañía (a través de los __libc_* de glibc) y las
+// llamadas de bloqueo que el programa o libstdc++ hacen a libc; lo que libc
+// llame por dentro no pasa por acá. Solo el hilo que está dentro de una zona
+// se vigila: el mismo hilo de audio puede esperar a ALSA fuera de ella.
+//
+// Define malloc y las demás en el programa, así que se incluye con
+// VIGILAR_RT en un solo .cpp por programa (todos los del piano son de un solo
+// archivo). Sin VIGILAR_RT la zona es una estructura vacía y no cuesta nada.
+//
+// Uso: g++ -DVIGILAR_RT -rdynamic ... (más -ldl con glibc anteriores a 2.34)
+
+#ifdef VIGILAR_RT
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <poll.h>
+#include <sys/select.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#define MAX_INFORMES_RT 20
+#define PROFUNDIDAD_BACKTRACE_RT 24
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+}
+
+namespace vigilante_rt {
+
+inline thread_local int zona = 0;             // anidamiento de ZonaTiempoReal
+inline thread_local bool informando = false;  // lo que hace el informe no cuenta
+inline std::atomic<uint64_t> violaciones{0};
+inline std::atomic<int> informes{0};
+
+// La función de libc que reemplazamos, buscada una vez
+template <typename F>
+F original(const char* nombre) {
+    return reinterpret_cast<F>(dlsym(RTLD_NEXT, nombre));
+}
+
+inline void escribirCrudo(const char* texto) {
+    static auto escribir = original<ssize_t (*)(int, const void*, size_t)>("write");
+    escribir(2, texto, strlen(texto));
+}
+
+inline void violacion(const char* que) {
+    if (!zona || informando) return;
+    informando = true;
+    violaciones.fetch_add(1, std::memory_order_relaxed);
+    if (informes.fetch_add(1, std::memory_order_relaxed) < MAX_INFORMES_RT) {
+        char texto[128];
+        snprintf(texto, sizeof(texto), "VIGILANTE RT: %s dentro de una zona de tiempo real\n", que);
+        escribirCrudo(texto);
+        void* marcos[PROFUNDIDAD_BACKTRACE_RT];
+        int n = backtrace(marcos, PROFUNDIDAD_BACKTRACE_RT);
+        // Se salta a sí misma y a la función interceptada
+        backtrace_symbols_fd(marcos + 2, n > 2 ? n - 2 : 0, 2);
+    }
+    const char* abortar = getenv("VIGILAR_RT_ABORTAR");
+    if (abortar && *abortar == '1') abort();
+    informando = false;
+}
+
+// backtrace() carga libgcc la primera vez, con malloc y dlopen: mejor antes
+// de la primera zona
+inline bool preparar() {
+    void* marco;
+    backtrace(&marco, 1);
+    return true;
+}
+inline bool preparado = preparar();
+
+}  // namespace vigilante_rt
+
+// Marca el alcance actual como de tiempo real
+struct ZonaTiempoReal {
+    ZonaTiempoReal() { ++vigilante_rt::zona; }
+    ~ZonaTiempoReal() { --vigilante_rt::zona; }
+    ZonaTiempoReal(const ZonaTiempoReal&) = delete;
+    ZonaTiempoReal& operator=(const ZonaTiempoReal&) = delete;
+};
+
+inline uint64_t violacionesTiempoReal() { return vigilante_rt::violaciones.load(std::memory_order_relaxed); }
+
+// --- Memoria ---
+
+extern "C" {
+
+void* malloc(size_t n) {
+    vigilante_rt::violacion("malloc");
+    return __libc_malloc(n);
+}
+
+void free(void* p) {
+    if (p) vigilante_rt::violacion("free");
+    __libc_free(p);
+}
+
+void* calloc(size_t n, size_t tam) {
+    vigilante_rt::violacion("calloc");
+    return __libc_calloc(n, tam);
+}
+
+void* realloc(void* p, size_t n) {
+    vigilante_rt::violacion("realloc");
+    return __libc_realloc(p, n);
+}
+
+void* memalign(size_t alineacion, size_t n) {
+    vigilante_rt::violacion("memalign");
+    return __libc_memalign(alineacion, n);
+}
+
+void* aligned_alloc(size_t alineacion, size_t n) {
+    vigilante_rt::violacion("aligned_alloc");
+    return __libc_memalign(alineacion, n);
+}
+
+int posix_memalign(void** p, size_t alineacion, size_t n) {
+    vigilante_rt::violacion("posix_memalign");
+    *p = __libc_memalign(alineacion, n);
+    return *p ? 0 : ENOMEM;
+}
+
+// --- Bloqueos ---
+
+#define VIGILAR_RT_REENVIAR(tipo, nombre, firma, argumentos)                 \
+    tipo nombre firma {                                                      \
+        vigilante_rt::violacion(#nombre);                                    \
+        static auto real = vigilante_rt::original<tipo(*) firma>(#nombre);   \
+        return real argumentos;                                              \
+    }
+
+VIGILAR_RT_REENVIAR(int, pthread_mutex_lock, (pthread_mutex_t* m), (m))
+VIGILAR_RT_REENVIAR(int, pthread_cond_wait, (pthread_cond_t* c, pthread_mutex_t* m), (c, m))
+VIGILAR_RT_REENVIAR(int, pthread_cond_timedwait, (pthread_cond_t* c, pthread_mutex_t* m, const timespec* t), (c, m, t))
+VIGILAR_RT_REENVIAR(int, pthread_rwlock_rdlock, (pthread_rwlock_t* l), (l))
+VIGILAR_RT_REENVIAR(int, pthread_rwlock_wrlock, (pthread_rwlock_t* l), (l))
+VIGILAR_RT_REENVIAR(int, pthread_join, (pthread_t h, void** r), (h, r))
+VIGILAR_RT_REENVIAR(int, sem_wait, (sem_t* s), (s))
+
+// --- Esperas ---
+
+VIGILAR_RT_REENVIAR(int, usleep, (useconds_t us), (us))
+VIGILAR_RT_REENVIAR(unsigned int, sleep, (unsigned int s), (s))
+VIGILAR_RT_REENVIAR(int, nanosleep, (const timespec* t, timespec* resto), (t, resto))
+VIGILAR_RT_REENVIAR(int, clock_nanosleep, (clockid_t c, int f, const timespec* t, timespec* resto), (c, f, t, resto))
+VIGILAR_RT_REENVIAR(int, poll, (pollfd* f, nfds_t n, int ms), (f, n, ms))
+VIGILAR_RT_REENVIAR(int, select, (int n, fd_set* l, fd_set* e, fd_set* x, timeval* t), (n, l, e, x, t))
+
+// --- E/S ---
+
+VIGILAR_RT_REENVIAR(ssize_t, read, (int fd, void* b, size_t n), (fd, b, n))
+VIGILAR_RT_REENVIAR(ssize_t, write, (int fd, const void* b, size_t n), (fd, b, n))
+VIGILAR_RT_REENVIAR(int, close, (int fd), (fd))
+VIGILAR_RT_REENVIAR(FILE*, fopen, (const char* r, const char* m), (r, m))
+VIGILAR_RT_REENVIAR(size_t, fwrite, (const void* b, size_t t, size_t n, FILE* f), (b, t, n, f))
+VIGILAR_RT_REENVIAR(int, fputs, (const char* s, FILE* f), (s, f))
+VIGILAR_RT_REENVIAR(int, puts, (const char* s), (s))
+VIGILAR_RT_REENVIAR(int, fflush, (FILE* f), (f))
+
+// El modo solo viene cuando se crea el archivo, como en open() de glibc;
+// leerlo sin que esté es comportamiento indefinido
+int open(const char* ruta, int flags, ...) {
+    vigilante_rt::violacion("open");
+    mode_t modo = 0;
+    if ((flags & O_CREAT) || (flags & O_TMPFILE) == O_TMPFILE) {
+        va_list a;
+        va_start(a, flags);
+        modo = mode_t(va_arg(a, int));
+        va_end(a);
+    }
+    static auto real = vigilante_rt::original<int (*)(const char*, int, ...)>("open");
+    return real(ruta, flags, modo);
+}
+
+int printf(const char* formato, ...) {
+    vigilante_rt::violacion("printf");
+    va_list a;
+    va_start(a, formato);
+    int n = vprintf(formato, a);
+    va_end(a);
+    return n;
+}
+
+int fprintf(FILE* f, const char* formato, ...) {
+    vigilante_rt::violacion("fprintf");
+    va_list a;
+    va_start(a, formato);
+    int n = vfprintf(f, formato, a);
+    va_end(a);
+    return n;
+}
+
+#undef VIGILAR_RT_REENVIAR
+
+}  // extern "C"
+
+#else
+
+// Constructor propio para que -Wall no la tome por una variable sin usar
+struct ZonaTiempoReal {
+    ZonaTiempoReal() {}
+};
+
+inline uint64_t violacionesTiempoReal() { return 0; }
+
+#endif
+
+#endif
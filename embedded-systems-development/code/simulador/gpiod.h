@@ -0,0 +1,346 @@
+#ifndef GPIOD_SIMULADO_H
+#define GPIOD_SIMULADO_H
+
+#define GPIO_SIMULADO
+
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "../piano/pines.h"
+#include "../piano/sintetizador.h"
+#include "../piano/captura.h"
+
+// Reemplazo de libgpiod para correr sin la placa. Se compila con
+// -I<code>/simulador y sin -lgpiod: cualquier #include <gpiod.h> trae esto y
+// las líneas del piano quedan conectadas a un modelo de software:
+//  - 74HC595 de columnas del teclado y 74HC165 de filas, con 25 teclas virtuales
+//  - 74HC595 de columnas y de filas de los LEDs (filas en lógica inversa)
+//  - los tres botones del menú
+// Las demás líneas guardan lo que se escribe y leen 0.
+//
+// Qué está apretado se decide con un guion (apretar, apretarBoton,
+// reproducirCaptura, o un archivo en la variable GPIO_GUION) y fijarTeclas(). esperarLeds() agrega
+// verificaciones: en ese momento tienen que estar encendidos exactamente esos
+// LEDs; las que fallan se juntan en fallas().
+//
+// El reloj es el real desde que se abre el chip, salvo que se pida el
+// virtual: ahí el tiempo solo avanza con esperar() (Matriz espera entre
+// flancos con esperarGpio) y una prueba corre mucho más rápido que en la
+// placa y siempre igual.
+//
+// Formato del guion, una acción por línea (tiempos en ms):
+//   100 tecla C4 250       apretada de 100 a 250
+//   100 boton ENT 200      IZQ, ENT, DER o número de línea
+//   300 leds C4 E4         encendidos exactamente esos ("-" = ninguno)
+//   500 captura toque.teclas 4   lo que leyó cada escaneo de main_menu
+//                                --capturar, desde 500 y 4 veces más rápido
+//                                (sin el número, a la velocidad original)
+
+struct gpiod_chip {
+    int abierto;
+};
+
+struct gpiod_line {
+    unsigned int pin;
+    int valor;
+    bool pedida;
+    const char* consumidor;
+};
+
+#define LINEAS_SIMULADAS 256
+#define SIEMPRE UINT64_MAX
+
+class PlacaSimulada {
+public:
+    static PlacaSimulada& global() {
+        static PlacaSimulada p;
+        return p;
+    }
+
+    // --- Reloj ---
+
+    void usarRelojVirtual(bool virtual_) {
+        relojVirtual = virtual_;
+        virtualUs = 0;
+    }
+
+    uint64_t ahoraUs() const {
+        if (relojVirtual) return virtualUs;
+        return inicioRealUs ? relojRealUs() - inicioRealUs : 0;
+    }
+
+    // Con reloj virtual avanza sin dormir; las verificaciones que caen en el
+    // medio se hacen con el estado de ahora, que no cambia mientras se espera
+    void esperar(uint64_t us) {
+        if (!relojVirtual) {
+            usleep(useconds_t(us));
+            verificar(ahoraUs());
+            return;
+        }
+        verificar(virtualUs + us);
+        virtualUs += us;
+    }
+
+    // --- Guion ---
+
+    void apretar(int nota, uint64_t desdeUs, uint64_t hastaUs = SIEMPRE) {
+        if (nota >= 0 && nota < NUM_NOTAS) intervalos.push_back({nota, 0, desdeUs, hastaUs});
+    }
+
+    void apretarBoton(unsigned int pin, uint64_t desdeUs, uint64_t hastaUs = SIEMPRE) {
+        intervalos.push_back({-1, pin, desdeUs, hastaUs});
+    }
+
+    void esperarLeds(uint64_t enUs, uint32_t leds) {
+        verificaciones.push_back({enUs, leds, false});
+    }
+
+    // Cada escaneo de la captura queda apretado hasta el siguiente, empezando
+    // en desdeUs; con velocidad > 1 los tiempos se acortan
+    void reproducirCaptura(const std::vector<MuestraEscaneo>& muestras, uint64_t desdeUs, double velocidad = 1.0) {
+        if (muestras.empty() || velocidad <= 0) return;
+        uint64_t primero = muestras.front().ns;
+        for (const auto& m : muestras)
+            capturadas.push_back({desdeUs + uint64_t(double(m.ns - primero) / 1000.0 / velocidad), m.teclas});
+        // Y todo suelto un escaneo después del último
+        size_t n = capturadas.size();
+        uint64_t ultimo = n > 1 ? capturadas[n - 1].us - capturadas[n - 2].us : 0;
+        capturadas.push_back({capturadas.back().us + std::max<uint64_t>(ultimo, 1), 0});
+        std::stable_sort(capturadas.begin(), capturadas.end(), [](const Escaneo& a, const Escaneo& b) { return a.us < b.us; });
+    }
+
+    // Teclas apretadas además de las del guion; se puede llamar desde otro hilo
+    void fijarTeclas(uint32_t teclas) { teclasFijas.store(teclas, std::memory_order_release); }
+
+    bool cargarGuion(const char* ruta) {
+        FILE* f = fopen(ruta, "r");
+        if (!f) return false;
+        char texto[256];
+        int numero = 0;
+        while (fgets(texto, sizeof(texto), f)) {
+            ++numero;
+            char que[16], nombre[200];
+            double ms, hastaMs;
+            int leidos = sscanf(texto, "%lf %15s %199s %lf", &ms, que, nombre, &hastaMs);
+            if (leidos < 2 || texto[0] == '#') continue;
+            uint64_t desde = uint64_t(ms * 1000), hasta = leidos == 4 ? uint64_t(hastaMs * 1000) : SIEMPRE;
+            if (!strcmp(que, "tecla") && leidos >= 3) {
+                apretar(indiceNota(nombre), desde, hasta);
+            } else if (!strcmp(que, "boton") && leidos >= 3) {
+                unsigned int pin = !strcmp(nombre, "IZQ") ? PIN_IZQ : !strcmp(nombre, "ENT") ? PIN_ENT
+                                 : !strcmp(nombre, "DER") ? PIN_DER : unsigned(atoi(nombre));
+                apretarBoton(pin, desde, hasta);
+            } else if (!strcmp(que, "leds")) {
+                uint32_t leds = 0;
+                char* resto = strstr(texto, "leds") + 4;
+                for (char* n = strtok(resto, " \t\r\n"); n; n = strtok(nullptr, " \t\r\n"))
+                    if (indiceNota(n) >= 0) leds |= 1u << indiceNota(n);
+                esperarLeds(desde, leds);
+            } else if (!strcmp(que, "captura") && leidos >= 3) {
+                std::vector<MuestraEscaneo> muestras;
+                if (leerCaptura(nombre, muestras)) reproducirCaptura(muestras, desde, leidos == 4 ? hastaMs : 1.0);
+                else fprintf(stderr, "%s:%d: no se pudo leer la captura %s\n", ruta, numero, nombre);
+            } else {
+                fprintf(stderr, "%s:%d: acción desconocida\n", ruta, numero);
+            }
+        }
+        fclose(f);
+        return true;
+    }
+
+    // --- Estado ---
+
+    uint32_t teclas() const { return teclasEn(ahoraUs()); }
+
+    // Un LED está encendido si su columna está en alto y su fila en bajo
+    uint32_t leds() const {
+        uint32_t encendidos = 0;
+        for (int col = 0; col < 5; ++col)
+            for (int row = 0; row < 5; ++row)
+                if ((columnasLed.salidas >> col & 1) && !(filasLed.salidas >> row & 1))
+                    encendidos |= 1u << notaEnMatriz(col, row);
+        return encendidos;
+    }
+
+    const std::vector<std::string>& fallas() const { return errores; }
+    int verificacionesHechas() const { return hechas; }
+
+    // --- Lo que usan las funciones gpiod_* ---
+
+    gpiod_chip* abrirChip(const char* nombre) {
+        if (strcmp(nombre, CHIPNAME)) {
+            errno = ENOENT;
+            return nullptr;
+        }
+        if (!inicioRealUs) inicioRealUs = relojRealUs();
+        chip.abierto = 1;
+        return &chip;
+    }
+
+    void cerrarChip() {
+        for (auto& l : lineas) l.pedida = false;
+        chip.abierto = 0;
+    }
+
+    gpiod_line* linea(unsigned int pin) {
+        if (pin >= LINEAS_SIMULADAS) {
+            errno = EINVAL;
+            return nullptr;
+        }
+        lineas[pin].pin = pin;
+        return &lineas[pin];
+    }
+
+    // Una línea se pide una sola vez, como con el driver de verdad
+    int pedir(gpiod_line* l, const char* consumidor, int valor) {
+        if (l->pedida) {
+            errno = EBUSY;
+            return -1;
+        }
+        l->pedida = true;
+        l->consumidor = consumidor;
+        l->valor = valor;
+        return 0;
+    }
+
+    int escribir(gpiod_line* l, int valor) {
+        verificar(ahoraUs());
+        bool sube = !l->valor && valor;
+        l->valor = valor;
+        // El 165 copia sus entradas mientras la carga está en bajo
+        if (l->pin == PIN_LATCH_IN && !valor) cargar165();
+        if (!sube) return 0;
+        switch (l->pin) {
+            case PIN_CLK_OUT:   columnasTeclado.desplazar(lineas[PIN_SER_OUT].valor); break;
+            case PIN_LATCH_OUT: columnasTeclado.copiar(); break;
+            case PIN_CLK_COL:   columnasLed.desplazar(lineas[PIN_SER_COL].valor); break;
+            case PIN_LATCH_COL: columnasLed.copiar(); break;
+            case PIN_CLK_ROW:   filasLed.desplazar(lineas[PIN_SER_ROW].valor); break;
+            case PIN_LATCH_ROW: filasLed.copiar(); break;
+            case PIN_CLK_IN:    filas165 = uint8_t(filas165 << 1); break;
+        }
+        return 0;
+    }
+
+    int leer(gpiod_line* l) {
+        uint64_t ahora = ahoraUs();
+        verificar(ahora);
+        if (l->pin == PIN_SER_IN) return filas165 >> 7 & 1;
+        for (const auto& i : intervalos)
+            if (i.nota < 0 && i.pin == l->pin && ahora >= i.desde && ahora < i.hasta) return 1;
+        return l->valor;
+    }
+
+    ~PlacaSimulada() {
+        if (verificaciones.empty()) return;
+        fprintf(stderr, "GPIO simulado: %d verificaciones de LEDs, %zu fallaron\n", hechas, errores.size());
+        for (const auto& e : errores) fprintf(stderr, "  %s\n", e.c_str());
+    }
+
+private:
+    // 74HC595: desplaza con el flanco de reloj, pasa a las salidas con el latch
+    struct Registro595 {
+        uint8_t desplazamiento = 0;
+        uint8_t salidas = 0;
+        void desplazar(int bit) { desplazamiento = uint8_t(desplazamiento << 1 | (bit & 1)); }
+        void copiar() { salidas = desplazamiento; }
+    };
+
+    struct Intervalo {
+        int nota;           // -1 = botón
+        unsigned int pin;
+        uint64_t desde, hasta;
+    };
+
+    struct Escaneo {
+        uint64_t us;
+        uint32_t teclas;
+    };
+
+    struct Verificacion {
+        uint64_t enUs;
+        uint32_t leds;
+        bool hecha;
+    };
+
+    gpiod_chip chip{0};
+    gpiod_line lineas[LINEAS_SIMULADAS] = {};
+    Registro595 columnasTeclado, columnasLed, filasLed;
+    uint8_t filas165 = 0;
+    std::vector<Intervalo> intervalos;
+    std::vector<Escaneo> capturadas;      // ordenadas por tiempo
+    std::vector<Verificacion> verificaciones;
+    std::vector<std::string> errores;
+    int hechas = 0;
+    std::atomic<uint32_t> teclasFijas{0};
+    bool relojVirtual = false;
+    uint64_t virtualUs = 0;
+    uint64_t inicioRealUs = 0;
+
+    PlacaSimulada() {
+        const char* guion = getenv("GPIO_GUION");
+        if (guion && !cargarGuion(guion)) fprintf(stderr, "No se pudo leer el guion %s\n", guion);
+    }
+
+    static uint64_t relojRealUs() {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return uint64_t(t.tv_sec) * 1000000ull + uint64_t(t.tv_nsec) / 1000;
+    }
+
+    uint32_t teclasEn(uint64_t us) const {
+        uint32_t t = teclasFijas.load(std::memory_order_acquire);
+        for (const auto& i : intervalos)
+            if (i.nota >= 0 && us >= i.desde && us < i.hasta) t |= 1u << i.nota;
+        auto despues = std::upper_bound(capturadas.begin(), capturadas.end(), us,
+                                        [](uint64_t u, const Escaneo& e) { return u < e.us; });
+        if (despues != capturadas.begin()) t |= (despues - 1)->teclas;
+        return t;
+    }
+
+    // Fila r del teclado entra por D r del 165 cuando su columna está activa
+    void cargar165() {
+        uint32_t t = teclasEn(ahoraUs());
+        filas165 = 0;
+        for (int col = 0; col < 5; ++col)
+            if (columnasTeclado.salidas >> col & 1)
+                for (int row = 0; row < 5; ++row)
+                    if (t & (1u << notaEnMatriz(col, row))) filas165 |= uint8_t(1 << row);
+    }
+
+    void verificar(uint64_t hasta) {
+        for (auto& v : verificaciones) {
+            if (v.hecha || v.enUs > hasta) continue;
+            v.hecha = true;
+            ++hechas;
+            uint32_t encendidos = leds();
+            if (encendidos == v.leds) continue;
+            char texto[96];
+            snprintf(texto, sizeof(texto), "a los %.1f ms: LEDs %07x, se esperaba %07x", v.enUs / 1000.0,
+                     unsigned(encendidos), unsigned(v.leds));
+            errores.push_back(texto);
+        }
+    }
+};
+
+inline void esperarGpio(unsigned int us) { PlacaSimulada::global().esperar(us); }
+
+// Lo que usa el piano de la API v1 de libgpiod
+inline gpiod_chip* gpiod_chip_open_by_name(const char* nombre) { return PlacaSimulada::global().abrirChip(nombre); }
+inline void gpiod_chip_close(gpiod_chip*) { PlacaSimulada::global().cerrarChip(); }
+inline gpiod_line* gpiod_chip_get_line(gpiod_chip*, unsigned int pin) { return PlacaSimulada::global().linea(pin); }
+inline int gpiod_line_request_output(gpiod_line* l, const char* consumidor, int valor) { return PlacaSimulada::global().pedir(l, consumidor, valor); }
+inline int gpiod_line_request_input(gpiod_line* l, const char* consumidor) { return PlacaSimulada::global().pedir(l, consumidor, 0); }
+inline void gpiod_line_release(gpiod_line* l) { l->pedida = false; }
+inline int gpiod_line_set_value(gpiod_line* l, int valor) { return PlacaSimulada::global().escribir(l, valor); }
+inline int gpiod_line_get_value(gpiod_line* l) { return PlacaSimulada::global().leer(l); }
+
+#endif
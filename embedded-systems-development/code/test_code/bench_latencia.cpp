@@ -0,0 +1,215 @@
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <gpiod.h>
+#include "../piano/matriz.h"
+#include "../piano/motor_audio.h"
+
+#ifndef GPIO_SIMULADO
+#error "Compilar con -I../simulador para usar el GPIO simulado"
+#endif
+
+// Latencia de punta a punta, de la tecla al sonido, sin la placa. Con el
+// GPIO simulado (simulador/gpiod.h) en tiempo real, Matriz::escanear() corre
+// igual que en el piano (con sus pausas) pero lee teclas que aprieta un hilo
+// de este programa. Otro hilo escanea como el bucle principal de main_menu y
+// el audio sale por el MotorAudio de siempre.
+//
+// Para cada pulsación se mide, desde que la tecla baja:
+//  - cuándo termina el escaneo que la ve (y se manda notaOn)
+//  - cuándo suena la primera muestra distinta de cero
+// Con el plugin "file" de ALSA (lo que se pide por defecto, a /dev/null) no
+// hay reloj: el observador hace de DAC, duerme al final de cada periodo hasta
+// que habría lugar en el buffer y la muestra s suena en inicio + s / 48 kHz.
+// Con un dispositivo de verdad (--dispositivo hw:0 o el de snd-aloop) el
+// momento se estima con lo que ALSA dice que falta por sonar.
+//
+// Entre pulsaciones se suelta la tecla y se espera silencio; la relajación se
+// acorta para que miles de pulsaciones tarden un minuto y no diez.
+//
+// Uso: g++ -O2 -I../simulador bench_latencia.cpp -o bench_latencia -lasound -lpthread
+//      ./bench_latencia [--pulsaciones N] [opciones de ALSA y tiempo real de main_menu]
+
+#define PULSACIONES 2000
+#define TICK_US 5000                    // el mismo ciclo que main_menu
+#define RELAJACION_BENCH_MS 2.0f
+#define ESPERA_MAXIMA_NS 1000000000ull  // sin sonido en un segundo se cuenta como perdida
+#define DISPOSITIVO_ARCHIVO "file:FILE=/dev/null,FORMAT=raw"
+
+struct Medicion {
+    MotorAudio* audio = nullptr;
+    bool relojSimulado = false;
+    uint64_t buffer = 0;                        // muestras que entran en el buffer de ALSA
+    uint64_t vistas = 0;                        // muestras que pasaron por el observador
+    uint64_t inicioDac = 0;                     // cuándo suena la muestra 0 (reloj simulado)
+    std::atomic<bool> esperando{false};         // hay una tecla abajo sin sonido todavía
+    std::atomic<uint64_t> escaneoNs{0};
+    std::atomic<uint64_t> sonidoNs{0};
+    std::atomic<bool> silencio{true};           // el último tramo fue todo ceros
+    std::atomic<uint32_t> teclasVistas{0};      // lo que vio el último escaneo
+    std::atomic<bool> escaneando{true};
+};
+
+static uint64_t muestrasANs(int64_t muestras) { return uint64_t(muestras * 1000000000ll / FRECUENCIA_MUESTREO); }
+
+static void sleepHasta(uint64_t ns) {
+    timespec t{time_t(ns / 1000000000ull), long(ns % 1000000000ull)};
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, nullptr);
+}
+
+// En el hilo de audio, con cada tramo ya renderizado
+static void observarSalida(const int16_t* muestras, int frames, void* contexto) {
+    Medicion& m = *static_cast<Medicion*>(contexto);
+    int primera = -1;
+    for (int i = 0; i < frames; ++i)
+        if (muestras[i]) {
+            primera = i;
+            break;
+        }
+    if (primera >= 0 && m.esperando.load(std::memory_order_acquire) && !m.sonidoNs.load(std::memory_order_relaxed)) {
+        int64_t s = int64_t(m.vistas) + primera;
+        uint64_t cuando;
+        if (m.relojSimulado) {
+            cuando = (m.inicioDac ? m.inicioDac : ahoraNs()) + muestrasANs(s);
+        } else {
+            cuando = ahoraNs() + muestrasANs(std::max<int64_t>(0, s - int64_t(m.audio->muestrasAudibles())));
+        }
+        m.sonidoNs.store(cuando, std::memory_order_release);
+    }
+    m.silencio.store(primera < 0, std::memory_order_release);
+    m.vistas += uint64_t(frames);
+
+    if (!m.relojSimulado) return;
+    // El DAC simulado arranca con el buffer lleno, como ALSA, y después deja
+    // lugar para un periodo cada periodo
+    if (!m.inicioDac && m.vistas >= m.buffer) m.inicioDac = ahoraNs();
+    int periodo = m.audio->tamPeriodo();
+    if (m.inicioDac && periodo && m.vistas % uint64_t(periodo) == 0)
+        sleepHasta(m.inicioDac + muestrasANs(int64_t(m.vistas) + periodo - int64_t(m.buffer)));
+}
+
+// Lo mismo que escanearYTocar() en main_menu, más la hora de fin del escaneo
+static void escanear(Matriz& matriz, MotorAudio& audio, Medicion& m) {
+    uint32_t antes = 0;
+    while (m.escaneando.load(std::memory_order_relaxed)) {
+        uint64_t ns = ahoraNs();
+        uint32_t teclas = matriz.escanear();
+        uint32_t cambios = teclas ^ antes;
+        for (int n = 0; n < NUM_NOTAS; ++n) {
+            if (!(cambios & (1u << n))) continue;
+            if (teclas & (1u << n)) {
+                audio.notaOn(n, ns);
+                if (!m.escaneoNs.load(std::memory_order_relaxed)) m.escaneoNs.store(ahoraNs(), std::memory_order_release);
+            } else {
+                audio.notaOff(n, ns);
+            }
+        }
+        antes = teclas;
+        m.teclasVistas.store(teclas, std::memory_order_release);
+        usleep(TICK_US);
+    }
+}
+
+static double percentil(const std::vector<double>& ordenados, double p) {
+    if (ordenados.empty()) return 0;
+    size_t i = size_t(p / 100.0 * double(ordenados.size() - 1) + 0.5);
+    return ordenados[std::min(i, ordenados.size() - 1)];
+}
+
+static void reportar(const char* nombre, std::vector<double>& ms) {
+    std::sort(ms.begin(), ms.end());
+    printf("%-26s %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f\n", nombre, ms.empty() ? 0 : ms.front(), percentil(ms, 50),
+           percentil(ms, 90), percentil(ms, 99), percentil(ms, 99.9), ms.empty() ? 0 : ms.back());
+}
+
+int main(int argc, char** argv) {
+    int pulsaciones = PULSACIONES;
+    bool otroDispositivo = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--pulsaciones") && i + 1 < argc) pulsaciones = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--dispositivo")) otroDispositivo = true;
+    }
+    ConfigTiempoReal rt;
+    leerConfigTiempoReal(argc, argv, rt);
+    ConfigAlsa alsa;
+    alsa.dispositivo = DISPOSITIVO_ARCHIVO;
+    leerConfigAlsa(argc, argv, alsa);
+    if (rt.activo) bloquearMemoria();
+
+    Matriz matriz;
+    if (!matriz.abrir("bench_latencia")) {
+        std::cerr << "No se pudo abrir el chip simulado\n";
+        return 1;
+    }
+
+    Medicion m;
+    m.relojSimulado = !otroDispositivo || !strncmp(alsa.dispositivo, "file:", 5) || !strcmp(alsa.dispositivo, "null");
+    MotorAudio audio;
+    m.audio = &audio;
+    Envolvente env;
+    env.relajacionMs = RELAJACION_BENCH_MS;
+    audio.fijarEnvolvente(env);
+    if (rt.activo) audio.configurarTiempoReal(rt.prioridadAudio, rt.cpuAudio);
+    if (!audio.abrir(alsa)) return 1;
+    audio.imprimirConfiguracion();
+    // El buffer lo negoció ALSA; el observador recién lo usa cuando lo llena
+    m.buffer = uint64_t(audio.tamBuffer());
+    audio.observar(observarSalida, &m);
+
+    std::thread escaneo([&]() {
+        if (rt.activo) {
+            fijarTiempoReal(rt.prioridadEscaneo, rt.cpuEscaneo, "escaneo");
+            prefaultPila();
+        }
+        escanear(matriz, audio, m);
+    });
+
+    printf("%d pulsaciones, %s\n", pulsaciones, m.relojSimulado ? "reloj de DAC simulado" : "reloj del dispositivo");
+    std::vector<double> hastaEscaneo, hastaSonido, escaneoASonido;
+    unsigned semilla = 1;
+    int perdidas = 0;
+    for (int p = 0; p < pulsaciones; ++p) {
+        // Silencio y teclas sueltas; después un tiempo al azar para no caer
+        // siempre en la misma fase del escaneo ni del periodo
+        while (!m.silencio.load(std::memory_order_acquire) || m.teclasVistas.load(std::memory_order_acquire)) usleep(200);
+        usleep(200 + rand_r(&semilla) % TICK_US);
+
+        int nota = p % NUM_NOTAS;
+        m.escaneoNs.store(0, std::memory_order_relaxed);
+        m.sonidoNs.store(0, std::memory_order_relaxed);
+        uint64_t apretada = ahoraNs();
+        m.esperando.store(true, std::memory_order_release);
+        PlacaSimulada::global().fijarTeclas(1u << nota);
+
+        uint64_t sonido = 0;
+        while (!(sonido = m.sonidoNs.load(std::memory_order_acquire)) && ahoraNs() - apretada < ESPERA_MAXIMA_NS) usleep(100);
+        m.esperando.store(false, std::memory_order_release);
+        PlacaSimulada::global().fijarTeclas(0);
+        uint64_t escaneado = m.escaneoNs.load(std::memory_order_acquire);
+        if (!sonido || !escaneado) {
+            ++perdidas;
+            continue;
+        }
+        hastaEscaneo.push_back((double(escaneado) - double(apretada)) / 1e6);
+        hastaSonido.push_back((double(sonido) - double(apretada)) / 1e6);
+        escaneoASonido.push_back((double(sonido) - double(escaneado)) / 1e6);
+    }
+
+    m.escaneando = false;
+    escaneo.join();
+    audio.cerrar();
+    matriz.cerrar();
+
+    printf("%-26s %7s %7s %7s %7s %7s %7s\n", "ms", "mín", "p50", "p90", "p99", "p99.9", "máx");
+    reportar("tecla -> fin del escaneo", hastaEscaneo);
+    reportar("escaneo -> primera muestra", escaneoASonido);
+    reportar("tecla -> primera muestra", hastaSonido);
+    if (perdidas) printf("%d pulsaciones sin sonido\n", perdidas);
+    printf("%llu xruns\n", (unsigned long long)audio.xruns());
+    return perdidas ? 1 : 0;
+}
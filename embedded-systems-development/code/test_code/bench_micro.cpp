@@ -0,0 +1,241 @@
+#include <gpiod.h>
+#include <sys/utsname.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "../piano/matriz.h"
+#include "../piano/motor_audio.h"
+#include "../oled/pantalla.h"
+#include "../oled/fuente.h"
+
+// Microbenchmarks de los caminos calientes, con salida JSON para comparar
+// corridas en la placa y en una PC a lo largo del tiempo
+// (test_code/comparar_bench.py compara dos archivos):
+//  - bus: una escritura y una lectura de línea, pulse, shiftOut y shiftIn
+//  - matriz: escaneo completo, escaneo + diferencias + cola de eventos
+//    (lo que hace escanearYTocar), encender un LED
+//  - síntesis: un periodo de 256 muestras con 1, 4 y 16 voces en cada modo,
+//    y sin voces (solo limpiar y convertir la mezcla)
+//  - pantalla: mostrar una pantalla (descomprimir y enviar), enviar el
+//    frame completo y escribir un campo de texto
+//  - trazas: un evento en el anillo del hilo (solo compilado con -DTRAZAS)
+//
+// El backend GPIO es el que se compile: libgpiod en la placa (con las pausas
+// de verdad entre flancos) o simulador/gpiod.h con -I../simulador, donde por
+// defecto el reloj es virtual y se mide solo el costo del software.
+//
+// Cada medición son TANDAS tandas de unos 5 ms (al menos una operación); se
+// informa la mediana, el mínimo y el p90 del tiempo por operación.
+//
+// Uso: ./bench_micro [--json archivo|-] [--fb ruta] [--paquete imagenes.pak] [--reloj-real]
+//      (compilar con -lgpiod en la placa o -I../simulador; -DFB_PATH para otro framebuffer)
+
+#define TANDAS 21
+#define NS_POR_TANDA 5000000.0
+#define PERIODO 256
+
+struct Resultado {
+    std::string nombre;
+    double mediana, minimo, p90;
+    long iteraciones;
+};
+
+std::vector<Resultado> resultados;
+FILE* tabla = stdout;     // stderr si el JSON sale por stdout
+
+template <typename F>
+void medir(const std::string& nombre, F&& operacion) {
+    // Cuántas operaciones entran en una tanda, con una de calentamiento
+    double t0 = double(ahoraNs());
+    operacion();
+    long n = 1;
+    while (double(ahoraNs()) - t0 < NS_POR_TANDA / 10) {
+        operacion();
+        ++n;
+    }
+    long porTanda = std::max(1L, long(NS_POR_TANDA / ((double(ahoraNs()) - t0) / double(n))));
+
+    std::vector<double> tandas(TANDAS);
+    for (double& t : tandas) {
+        uint64_t inicio = ahoraNs();
+        for (long i = 0; i < porTanda; ++i) operacion();
+        t = double(ahoraNs() - inicio) / double(porTanda);
+    }
+    std::sort(tandas.begin(), tandas.end());
+    Resultado r{nombre, tandas[TANDAS / 2], tandas[0], tandas[TANDAS * 9 / 10], porTanda * TANDAS};
+    fprintf(tabla, "%-34s %12.1f %12.1f %12.1f ns\n", r.nombre.c_str(), r.mediana, r.minimo, r.p90);
+    fflush(tabla);
+    resultados.push_back(r);
+}
+
+// Las primitivas del bus son protegidas en Matriz
+class MatrizMedida : public Matriz {
+public:
+    void escribirLinea(int valor) { gpiod_line_set_value(serOut, valor); }
+    int leerLinea() { return gpiod_line_get_value(serIn); }
+    void pulso() { pulse(clkOut); }
+    void enviar(uint8_t valor) { shiftOut(serOut, clkOut, latchOut, valor); }
+    uint8_t recibir() { return shiftIn(); }
+};
+
+void medirMatriz() {
+    MatrizMedida matriz;
+    if (!matriz.abrir("bench_micro")) {
+        fprintf(stderr, "No se pudo abrir la matriz, se omite el bus\n");
+        return;
+    }
+    int valor = 0;
+    medir("gpio.set_value", [&] { matriz.escribirLinea(valor ^= 1); });
+    medir("gpio.get_value", [&] { valor += matriz.leerLinea(); });
+    medir("gpio.pulse", [&] { matriz.pulso(); });
+    medir("gpio.shiftOut", [&] { matriz.enviar(uint8_t(++valor)); });
+    medir("gpio.shiftIn", [&] { valor += matriz.recibir(); });
+    medir("matriz.escanear", [&] { valor += int(matriz.escanear()); });
+
+    // Como escanearYTocar: diferencias contra el escaneo anterior y un evento
+    // por tecla que cambió. En el simulador las teclas alternan entre dos
+    // acordes para que siempre haya algo que mandar.
+    ColaEventos<EventoTeclado, TAM_COLA_EVENTOS> cola;
+    uint32_t antes = 0;
+    int vez = 0;
+    medir("matriz.escanear_despachar", [&] {
+#ifdef GPIO_SIMULADO
+        PlacaSimulada::global().fijarTeclas(++vez % 2 ? 0x0000111u : 0x1010000u);
+#endif
+        uint64_t ns = ahoraNs();
+        uint32_t teclas = matriz.escanear();
+        uint32_t cambios = teclas ^ antes;
+        for (int n = 0; n < NUM_NOTAS; ++n)
+            if (cambios & (1u << n)) cola.poner({ns, n, bool(teclas & (1u << n))});
+        antes = teclas;
+        while (cola.frente()) cola.sacar();
+    });
+#ifdef GPIO_SIMULADO
+    PlacaSimulada::global().fijarTeclas(0);
+#endif
+    (void)vez;
+    medir("matriz.encenderLed", [&] { matriz.encenderLed(++valor % NUM_NOTAS); });
+    matriz.apagarLeds();
+    matriz.cerrar();
+}
+
+void medirSintesis() {
+    const char* nombresModos[] = { "viva", "cache" };
+    const char* nombresAritmetica[] = { "flotante", "q15" };
+    int16_t buffer[PERIODO];
+    for (int a = 0; a < 2; ++a) {
+        Sintetizador vacio;
+        vacio.fijarAritmetica(Aritmetica(a));
+        medir(std::string("sintesis.sin_voces.") + nombresAritmetica[a], [&] { vacio.render(buffer, PERIODO); });
+    }
+    for (int m = 0; m < 2; ++m)
+        for (int a = 0; a < 2; ++a)
+            for (int voces : {1, 4, 16}) {
+                Sintetizador sinte;
+                sinte.fijarModo(ModoSintesis(m));
+                sinte.fijarAritmetica(Aritmetica(a));
+                sinte.fijarPolifonia(MAX_VOCES, ROBAR_VIEJA);
+                for (int n = 0; n < voces; ++n) sinte.notaOn(n);
+                std::string nombre = std::string("sintesis.") + nombresModos[m] + "." + nombresAritmetica[a] + "." +
+                                     std::to_string(voces) + "_voces";
+                medir(nombre, [&] { sinte.render(buffer, PERIODO); });
+            }
+}
+
+void medirPantalla(const char* fb, const char* paquete) {
+    Pantalla pantalla;
+    if (!pantalla.abrir(fb, paquete)) {
+        fprintf(stderr, "Se omite la pantalla\n");
+        return;
+    }
+    int vez = 0;
+    medir("pantalla.mostrar", [&] { pantalla.mostrar(vez++ % 2 ? T_ESTRELLITA : MENU_NORMAL); });
+    // Invertir un byte por página obliga a mandar las ocho
+    medir("pantalla.enviar_frame", [&] {
+        for (int p = 0; p < NUM_PAGINAS; ++p) pantalla.datos()[p * BYTES_PAGINA] ^= 1;
+        pantalla.marcarFilas(0, HEIGHT - 1);
+        pantalla.enviar(false);
+    });
+    const char* textos[] = { "C4", "A#5" };
+    medir("pantalla.campo_texto", [&] { escribirCampo(pantalla, 8, CAMPO_NORMAL_NOTA_R, 8, textos[vez++ % 2]); });
+    pantalla.cerrar();
+}
+
+void medirTrazas() {
+#ifdef TRAZAS
+    int nota = 0;
+    medir("traza.evento", [&] { TRAZA_INSTANTE(TRAZA_TECLA, ++nota & 31); });
+#endif
+}
+
+// Texto JSON sin caracteres de control ni comillas sueltas
+std::string json(const std::string& s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        if (uint8_t(c) >= 0x20) r += c;
+    }
+    return r;
+}
+
+void escribirJson(FILE* f, const std::string& gpio) {
+    utsname u;
+    uname(&u);
+    char fecha[32];
+    time_t ahora = time(nullptr);
+    strftime(fecha, sizeof(fecha), "%Y-%m-%dT%H:%M:%SZ", gmtime(&ahora));
+    fprintf(f, "{\n  \"maquina\": \"%s\",\n  \"sistema\": \"%s %s\",\n  \"arquitectura\": \"%s\",\n", json(u.nodename).c_str(),
+            json(u.sysname).c_str(), json(u.release).c_str(), json(u.machine).c_str());
+    fprintf(f, "  \"compilador\": \"%s\",\n  \"gpio\": \"%s\",\n  \"fecha\": \"%s\",\n  \"unidad\": \"ns/op\",\n",
+            json(__VERSION__).c_str(), json(gpio).c_str(), fecha);
+    fprintf(f, "  \"resultados\": [\n");
+    for (size_t i = 0; i < resultados.size(); ++i) {
+        const Resultado& r = resultados[i];
+        fprintf(f, "    {\"nombre\": \"%s\", \"mediana\": %.1f, \"minimo\": %.1f, \"p90\": %.1f, \"iteraciones\": %ld}%s\n",
+                json(r.nombre).c_str(), r.mediana, r.minimo, r.p90, r.iteraciones, i + 1 < resultados.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    const char* salidaJson = nullptr;
+    const char* fb = FB_PATH;
+    const char* paquete = nullptr;     // el de Pantalla::abrir
+    bool relojReal = false;
+    for (int i = 1; i < argc; ++i) {
+        bool hayValor = i + 1 < argc;
+        if (!strcmp(argv[i], "--json") && hayValor) salidaJson = argv[++i];
+        else if (!strcmp(argv[i], "--fb") && hayValor) fb = argv[++i];
+        else if (!strcmp(argv[i], "--paquete") && hayValor) paquete = argv[++i];
+        else if (!strcmp(argv[i], "--reloj-real")) relojReal = true;
+    }
+
+#ifdef GPIO_SIMULADO
+    PlacaSimulada::global().usarRelojVirtual(!relojReal);
+    std::string gpio = relojReal ? "simulado, reloj real" : "simulado, reloj virtual";
+#else
+    std::string gpio = "libgpiod";
+    (void)relojReal;
+#endif
+
+    if (salidaJson && !strcmp(salidaJson, "-")) tabla = stderr;
+    fprintf(tabla, "%-34s %12s %12s %12s\n", "", "mediana", "mínimo", "p90");
+    medirMatriz();
+    medirSintesis();
+    medirPantalla(fb, paquete);
+    medirTrazas();
+
+    if (salidaJson) {
+        FILE* f = strcmp(salidaJson, "-") ? fopen(salidaJson, "w") : stdout;
+        if (!f) {
+            perror(salidaJson);
+            return 1;
+        }
+        escribirJson(f, gpio);
+        if (f != stdout) fclose(f);
+    }
+    return 0;
+}
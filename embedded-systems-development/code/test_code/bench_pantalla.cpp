@@ -0,0 +1,82 @@
+#include <iostream>
+#include <string>
+#include <ctime>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../oled/pantalla.h"
+#include "../oled/fuente.h"
+
+// Compara cambiar de pantalla lanzando los programas o_* (como hacía el menú)
+// contra el cache en memoria de Pantalla, simulando un scroll rápido por el menú.
+// También mide cuánto cuesta escribir una línea de texto en la sombra.
+// Ejecutar desde la carpeta donde están compilados los o_*.
+
+#define CAMBIOS_PROCESO 50
+#define CAMBIOS_CACHE 1000
+#define LINEAS_TEXTO 10000
+
+double ahoraUs() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+const char* programas[] = { "o_t_estrellita", "o_t_hbd", "o_t_piratas", "o_t_pollitos" };
+const IdPantalla ids[] = { T_ESTRELLITA, T_HBD, T_PIRATAS, T_POLLITOS };
+
+void reportar(const char* nombre, double total, double peor, int n) {
+    std::cout << nombre << ": promedio " << total / n << " us, peor " << peor << " us (" << n << " cambios)\n";
+}
+
+int main() {
+    double total = 0, peor = 0;
+    for (int i = 0; i < CAMBIOS_PROCESO; ++i) {
+        std::string programa = programas[i % 4];
+        double t0 = ahoraUs();
+        pid_t pid = fork();
+        if (pid == 0) {
+            freopen("/dev/null", "w", stdout);
+            execl(("./" + programa).c_str(), programa.c_str(), nullptr);
+            _exit(1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        double dt = ahoraUs() - t0;
+        total += dt;
+        if (dt > peor) peor = dt;
+    }
+    reportar("fork + execl o_*", total, peor, CAMBIOS_PROCESO);
+
+    Pantalla pantalla;
+    if (!pantalla.abrir()) return 1;
+
+    total = 0;
+    peor = 0;
+    for (int i = 0; i < CAMBIOS_CACHE; ++i) {
+        double t0 = ahoraUs();
+        pantalla.mostrar(ids[i % 4]);
+        double dt = ahoraUs() - t0;
+        total += dt;
+        if (dt > peor) peor = dt;
+    }
+    reportar("cache en proceso", total, peor, CAMBIOS_CACHE);
+
+    // Fila múltiplo de 8 (un byte por columna) y desalineada (dos bytes)
+    const int filas[] = { CAMPO_TUTOR_R, CAMPO_TUTOR_R + 3 };
+    const char* nombres[] = { "texto alineado", "texto desalineado" };
+    for (int f = 0; f < 2; ++f) {
+        total = 0;
+        peor = 0;
+        for (int i = 0; i < LINEAS_TEXTO; ++i) {
+            double t0 = ahoraUs();
+            escribirCampo(pantalla, 2, filas[f], CARACTERES_LINEA, (i & 1) ? "Toca C#5" : "Toca G4");
+            double dt = ahoraUs() - t0;
+            total += dt;
+            if (dt > peor) peor = dt;
+        }
+        reportar(nombres[f], total, peor, LINEAS_TEXTO);
+    }
+
+    pantalla.cerrar();
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <ctime>
+#include <unistd.h>
+#include "../piano/registro.h"
+#include "../piano/sintetizador.h"
+
+// Costo de registrar del lado de quien toca: cada llamada se mide sola, con
+// el hilo del registro corriendo y escribiendo a un archivo. Para comparar,
+// también se mide escribir la misma línea con std::cout (redirigir la
+// salida a la consola serie o a /dev/null según lo que se quiera ver).
+
+#define LLAMADAS 20000
+#define RAFAGA 200   // registros seguidos antes de dejar que el hilo vacíe
+
+double ahoraNs() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+void reportar(const char* nombre, double total, double peor, int n) {
+    std::cerr << nombre << ": promedio " << total / n << " ns, peor " << peor << " ns (" << n << " llamadas)\n";
+}
+
+int main(int argc, char** argv) {
+    Registro::global().iniciar(argc > 1 ? argv[1] : "/dev/null");
+
+    double total = 0, peor = 0;
+    for (int i = 0; i < LLAMADAS; ++i) {
+        double t0 = ahoraNs();
+        registrar(REG_NOTA_ON, i % NUM_NOTAS, 0, 0, nombreNota(i % NUM_NOTAS));
+        double dt = ahoraNs() - t0;
+        total += dt;
+        if (dt > peor) peor = dt;
+        if (i % RAFAGA == RAFAGA - 1) usleep(INTERVALO_REGISTRO_MS * 1000);
+    }
+    reportar("registro binario", total, peor, LLAMADAS);
+    Registro::global().detener();
+    std::cerr << "descartados: " << Registro::global().registrosDescartados() << "\n";
+
+    total = 0;
+    peor = 0;
+    for (int i = 0; i < LLAMADAS / 10; ++i) {
+        double t0 = ahoraNs();
+        std::cout << "Tocando: " << nombresNotas[i % NUM_NOTAS] << "\n";
+        double dt = ahoraNs() - t0;
+        total += dt;
+        if (dt > peor) peor = dt;
+    }
+    std::cout.flush();
+    reportar("std::cout", total, peor, LLAMADAS / 10);
+    return 0;
+}
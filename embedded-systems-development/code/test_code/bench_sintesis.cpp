@@ -0,0 +1,68 @@
+#include <iostream>
+#include <ctime>
+#include "../piano/sintetizador.h"
+
+// CPU por voz de la síntesis viva (tabla de seno por muestra, como Faust)
+// contra los bucles pre-renderizados, con 1, 5, 10 y 25 voces sonando, en
+// aritmética flotante y Q15 (compilar con -mfpu=neon en la placa). Al
+// final, el costo de un periodo con todas las teclas apretadas y la polifonía
+// por defecto, que no debería pasar del de POLIFONIA voces.
+
+#define PERIODO 256
+#define SEGUNDOS_AUDIO 10
+
+double ahoraNs() {
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// Nanosegundos de CPU por voz y por muestra
+double medir(ModoSintesis modo, Aritmetica aritmetica, int voces) {
+    Sintetizador sinte;
+    sinte.fijarModo(modo);
+    sinte.fijarAritmetica(aritmetica);
+    sinte.fijarPolifonia(MAX_VOCES, ROBAR_VIEJA);
+    for (int n = 0; n < voces; ++n) sinte.notaOn(n);
+
+    int16_t buffer[PERIODO];
+    long periodos = long(SEGUNDOS_AUDIO) * FRECUENCIA_MUESTREO / PERIODO;
+    double t0 = ahoraNs();
+    for (long i = 0; i < periodos; ++i) sinte.render(buffer, PERIODO);
+    double dt = ahoraNs() - t0;
+    return dt / (double(periodos) * PERIODO * voces);
+}
+
+// Microsegundos de CPU por periodo con "teclas" notas apretadas
+double periodoUs(int teclas, int polifonia) {
+    Sintetizador sinte;
+    sinte.fijarPolifonia(polifonia, ROBAR_VIEJA);
+    for (int n = 0; n < teclas; ++n) sinte.notaOn(n);
+
+    int16_t buffer[PERIODO];
+    long periodos = long(SEGUNDOS_AUDIO) * FRECUENCIA_MUESTREO / PERIODO;
+    double t0 = ahoraNs();
+    for (long i = 0; i < periodos; ++i) sinte.render(buffer, PERIODO);
+    return (ahoraNs() - t0) / 1e3 / periodos;
+}
+
+int main() {
+    std::cout << "Cache de bucles: " << CacheBucles::global().bytes() / 1024 << " KB\n";
+    const int voces[] = { 1, 5, 10, 25 };
+    std::cout << "ns por voz y muestra\n";
+    for (int v : voces) {
+        double viva = medir(SINTESIS_VIVA, ARITMETICA_FLOTANTE, v);
+        double vivaQ15 = medir(SINTESIS_VIVA, ARITMETICA_Q15, v);
+        double cache = medir(SINTESIS_CACHE, ARITMETICA_FLOTANTE, v);
+        double cacheQ15 = medir(SINTESIS_CACHE, ARITMETICA_Q15, v);
+        std::cout << v << " voces: viva " << viva << " (Q15 " << vivaQ15 << ", " << viva / vivaQ15
+                  << "x), cache " << cache << " (Q15 " << cacheQ15 << ", " << cache / cacheQ15
+                  << "x), cache/viva " << viva / cache << "x\n";
+    }
+
+    std::cout << "Periodo de " << PERIODO << " muestras, viva: " << POLIFONIA << " teclas "
+              << periodoUs(POLIFONIA, POLIFONIA) << " us, " << NUM_NOTAS << " teclas con polifonía "
+              << POLIFONIA << " " << periodoUs(NUM_NOTAS, POLIFONIA) << " us, " << NUM_NOTAS
+              << " teclas sin límite " << periodoUs(NUM_NOTAS, MAX_VOCES) << " us\n";
+    return 0;
+}
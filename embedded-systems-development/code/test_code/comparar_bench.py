@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Compara dos salidas de bench_micro --json (antes y después, o la PC
+contra la placa): muestra la mediana de cada medición en los dos archivos y
+la razón, y marca lo que empeoró más que el umbral.
+
+Uso: python3 comparar_bench.py antes.json despues.json [--umbral 10]
+Sale con 1 si algo empeoró más del umbral (en %)."""
+
+import json
+import sys
+
+
+def cargar(ruta):
+    with open(ruta) as f:
+        datos = json.load(f)
+    return datos, {r["nombre"]: r for r in datos["resultados"]}
+
+
+def main():
+    args = sys.argv[1:]
+    umbral = 10.0
+    if "--umbral" in args:
+        i = args.index("--umbral")
+        umbral = float(args[i + 1])
+        del args[i:i + 2]
+    if len(args) != 2:
+        print(__doc__)
+        return 2
+
+    antes, medidas_antes = cargar(args[0])
+    despues, medidas_despues = cargar(args[1])
+    for nombre, d in (("antes", antes), ("después", despues)):
+        print(f"{nombre}: {d['maquina']} ({d['arquitectura']}), {d['compilador']}, GPIO {d['gpio']}, {d['fecha']}")
+
+    peores = 0
+    print(f"\n{'':34} {'antes':>12} {'después':>12} {'razón':>8}")
+    for nombre, r in medidas_antes.items():
+        if nombre not in medidas_despues:
+            print(f"{nombre:34} {r['mediana']:12.1f} {'-':>12}")
+            continue
+        nuevo = medidas_despues[nombre]["mediana"]
+        razon = nuevo / r["mediana"] if r["mediana"] else float("inf")
+        marca = ""
+        if razon > 1 + umbral / 100:
+            marca = "  peor"
+            peores += 1
+        elif razon < 1 - umbral / 100:
+            marca = "  mejor"
+        print(f"{nombre:34} {r['mediana']:12.1f} {nuevo:12.1f} {razon:8.2f}{marca}")
+    for nombre in medidas_despues:
+        if nombre not in medidas_antes:
+            print(f"{nombre:34} {'-':>12} {medidas_despues[nombre]['mediana']:12.1f}")
+    return 1 if peores else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+#include "../piano/tiempo_real.h"
+
+// Mide cuánto tarda en despertar un hilo que hace lo mismo que el de audio
+// (dormir un periodo de 256 muestras a 48 kHz y volver), primero con la
+// configuración por defecto y después con SCHED_FIFO, núcleo fijo, mlockall y
+// pila precargada. Mientras tanto otros hilos cargan los dos núcleos
+// escribiendo texto y pidiendo memoria, como hacía std::cout en el piano.
+//
+// Uso: ./latencia_rt [segundos por prueba]   (como root para SCHED_FIFO)
+
+#define PERIODO_US 5333
+#define HILOS_CARGA 4
+#define NUM_CUBETAS 7
+
+const double limites[NUM_CUBETAS - 1] = { 50, 100, 200, 500, 1000, 2000 };
+
+std::atomic<bool> cargando{true};
+
+void carga(int id) {
+    std::ofstream nulo("/dev/null");
+    std::vector<char*> bloques;
+    unsigned semilla = unsigned(id);
+    while (cargando) {
+        nulo << "Tocando: C4 (PID: " << rand_r(&semilla) << ")" << std::endl;
+        bloques.push_back(static_cast<char*>(malloc(4096 + rand_r(&semilla) % 65536)));
+        if (bloques.size() > 256) {
+            for (char* b : bloques) free(b);
+            bloques.clear();
+        }
+    }
+    for (char* b : bloques) free(b);
+}
+
+struct Resultado {
+    long despertares = 0;
+    double peorUs = 0;
+    double totalUs = 0;
+    long histograma[NUM_CUBETAS] = {};
+};
+
+void medir(bool tiempoReal, int segundos, Resultado& r) {
+    if (tiempoReal) {
+        fijarTiempoReal(PRIORIDAD_AUDIO, CPU_AUDIO, "medición");
+        prefaultPila();
+    }
+
+    timespec siguiente;
+    clock_gettime(CLOCK_MONOTONIC, &siguiente);
+    long total = long(segundos) * 1000000L / PERIODO_US;
+    for (long i = 0; i < total; ++i) {
+        siguiente.tv_nsec += PERIODO_US * 1000L;
+        while (siguiente.tv_nsec >= 1000000000L) {
+            siguiente.tv_nsec -= 1000000000L;
+            ++siguiente.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &siguiente, nullptr);
+
+        timespec ahora;
+        clock_gettime(CLOCK_MONOTONIC, &ahora);
+        double retraso = (ahora.tv_sec - siguiente.tv_sec) * 1e6 + (ahora.tv_nsec - siguiente.tv_nsec) / 1e3;
+        if (retraso > r.peorUs) r.peorUs = retraso;
+        r.totalUs += retraso;
+        int c = 0;
+        while (c < NUM_CUBETAS - 1 && retraso >= limites[c]) ++c;
+        ++r.histograma[c];
+        ++r.despertares;
+    }
+}
+
+void prueba(const char* nombre, bool tiempoReal, int segundos) {
+    cargando = true;
+    std::vector<std::thread> hilos;
+    for (int i = 0; i < HILOS_CARGA; ++i) hilos.emplace_back(carga, i);
+
+    Resultado r;
+    std::thread medidor(medir, tiempoReal, segundos, std::ref(r));
+    medidor.join();
+    cargando = false;
+    for (auto& h : hilos) h.join();
+
+    std::cout << nombre << ": " << r.despertares << " despertares, promedio "
+              << r.totalUs / r.despertares << " us, peor " << r.peorUs << " us\n";
+    for (int i = 0; i < NUM_CUBETAS; ++i) {
+        if (i < NUM_CUBETAS - 1) std::cout << "  < " << limites[i] << " us: " << r.histograma[i] << "\n";
+        else std::cout << "  más: " << r.histograma[i] << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    int segundos = argc > 1 ? atoi(argv[1]) : 10;
+
+    prueba("Antes (SCHED_OTHER)", false, segundos);
+
+    bloquearMemoria();
+    prueba("Después (SCHED_FIFO, núcleo fijo, mlockall)", true, segundos);
+    return 0;
+}
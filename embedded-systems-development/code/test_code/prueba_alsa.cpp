@@ -0,0 +1,108 @@
+#include <unistd.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include "../piano/motor_audio.h"
+
+// Prueba la salida de audio sin la placa, con el plugin "file" de ALSA: lo
+// que se escribe termina en un archivo crudo (el esclavo es "null", que
+// acepta todo enseguida). Para cada configuración toca A4 un segundo y revisa
+// que se haya negociado lo pedido, que el archivo tenga el A4 afinado, que
+// no falten muestras y que no haya xruns.
+//
+// Uso: ./prueba_alsa [archivo temporal]
+
+#define NOTA 9                  // A4
+#define SEGUNDOS_NOTA 1
+#define TOLERANCIA_HZ 1.0
+
+struct Caso {
+    const char* nombre;
+    unsigned periodo, periodos;
+    bool mmap;
+};
+
+// Cruces por cero hacia arriba, interpolados, entre "desde" y "hasta"
+double frecuencia(const std::vector<int16_t>& m, size_t desde, size_t hasta) {
+    double primero = -1, ultimo = -1;
+    int cruces = 0;
+    for (size_t i = desde + 1; i < hasta && i < m.size(); ++i) {
+        if (m[i - 1] < 0 && m[i] >= 0) {
+            double t = double(i - 1) + double(-m[i - 1]) / double(m[i] - m[i - 1]);
+            if (primero < 0) primero = t;
+            else ++cruces;
+            ultimo = t;
+        }
+    }
+    return cruces > 0 ? cruces * double(FRECUENCIA_MUESTREO) / (ultimo - primero) : 0;
+}
+
+bool probar(const Caso& c, const std::string& archivo) {
+    unlink(archivo.c_str());
+    std::string dispositivo = "file:FILE=" + archivo + ",FORMAT=raw";
+    ConfigAlsa config;
+    config.dispositivo = dispositivo.c_str();
+    config.periodo = c.periodo;
+    config.periodos = c.periodos;
+    config.mmap = c.mmap;
+
+    MotorAudio audio;
+    if (!audio.abrir(config)) {
+        std::cout << c.nombre << ": no se pudo abrir " << dispositivo << " FALLA\n";
+        return false;
+    }
+    std::cout << c.nombre << ": ";
+    audio.imprimirConfiguracion();
+
+    // El esclavo null no tiene reloj: el hilo de audio corre tan rápido como puede
+    // y la nota empieza donde vaya cuando llega el evento
+    uint64_t largo = uint64_t(SEGUNDOS_NOTA) * FRECUENCIA_MUESTREO;
+    uint64_t apagar = audio.muestrasEscritas() + largo;
+    audio.notaOn(NOTA);
+    while (audio.muestrasEscritas() < apagar) usleep(1000);
+    audio.notaOff(NOTA);
+    while (audio.muestrasEscritas() < apagar + largo) usleep(1000);
+    audio.cerrar();
+    uint64_t escritas = audio.muestrasEscritas();
+
+    std::ifstream f(archivo, std::ios::binary | std::ios::ate);
+    size_t bytes = f ? size_t(f.tellg()) : 0;
+    std::vector<int16_t> muestras(bytes / 2);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(muestras.data()), std::streamsize(muestras.size() * 2));
+
+    size_t inicio = 0;
+    while (inicio < muestras.size() && muestras[inicio] == 0) ++inicio;
+    // Medio segundo del sostenido, lejos del ataque y de la relajación
+    double hz = frecuencia(muestras, inicio + FRECUENCIA_MUESTREO / 4, inicio + 3 * FRECUENCIA_MUESTREO / 4);
+
+    bool negociado = audio.tamPeriodo() == int(c.periodo) && audio.usaMmap() == c.mmap;
+    // El plugin puede quedarse con menos de un buffer sin volcar al cerrar
+    bool completo = muestras.size() + c.periodo * c.periodos >= escritas && escritas >= apagar + largo;
+    bool afinado = std::fabs(hz - frecuencias[NOTA]) <= TOLERANCIA_HZ;
+    bool sinXruns = audio.xruns() == 0;
+
+    std::cout << "  periodo " << audio.tamPeriodo() << (audio.usaMmap() ? " con mmap " : " con writei ")
+              << (negociado ? "ok" : "FALLA") << "\n";
+    std::cout << "  " << muestras.size() << " muestras en el archivo, " << escritas << " escritas "
+              << (completo ? "ok" : "FALLA") << "\n";
+    std::cout << "  A4 medido " << hz << " Hz " << (afinado ? "ok" : "FALLA") << "\n";
+    std::cout << "  " << audio.xruns() << " xruns " << (sinXruns ? "ok" : "FALLA") << "\n";
+    unlink(archivo.c_str());
+    return negociado && completo && afinado && sinXruns;
+}
+
+int main(int argc, char** argv) {
+    std::string archivo = argc > 1 ? argv[1] : "/tmp/prueba_alsa.raw";
+    const Caso casos[] = {
+        { "mmap", PERIODO_ALSA, PERIODOS_ALSA, true },
+        { "mmap baja latencia", PERIODO_BAJA_LATENCIA, PERIODOS_BAJA_LATENCIA, true },
+        { "writei", PERIODO_ALSA, PERIODOS_ALSA, false },
+    };
+    bool ok = true;
+    for (const Caso& c : casos) ok = probar(c, archivo) && ok;
+    std::cout << (ok ? "Salida de audio correcta\n" : "La salida de audio falla\n");
+    return ok ? 0 : 1;
+}
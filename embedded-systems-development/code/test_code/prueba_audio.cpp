@@ -0,0 +1,223 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include "../piano/sintetizador.h"
+#include "../piano/linea_tiempo.h"
+
+// Pruebas de regresión del sonido. Cada una de las 25 notas se renderiza
+// sola en las cuatro combinaciones (viva o cache, flotante o Q15) y se mide:
+//  - la frecuencia fundamental, contra el temperamento igual (A4 = 440 Hz)
+//  - THD (armónicos 2 a 10) y THD+N (todo lo que no es la fundamental)
+//  - cuántas muestras después del evento empieza y termina el sonido
+// La síntesis viva flotante es la misma cuenta que los .dsp de piano/notes
+// (tabla de 65536 puntos, índice truncado), así que esto también los mide.
+//
+// Los valores se comparan con los guardados en audio_referencia.txt, con las
+// tolerancias de abajo; además la afinación tiene un límite absoluto. Si un
+// cambio mejora el sonido, o lo empeora a propósito, se regenera el archivo
+// con --actualizar y se sube junto con el cambio.
+//
+// Uso: ./prueba_audio [audio_referencia.txt] [--actualizar]
+
+#define PERIODO 256
+#define INICIO_NOTA 2400               // 50 ms de silencio antes
+#define DURACION_NOTA 38400            // 800 ms apretada
+#define DESDE_ANALISIS 9600            // se analiza el sostenido: 200 ms después del inicio...
+#define LARGO_ANALISIS 24000           // ...durante 500 ms
+#define TOTAL_MUESTRAS 57600
+#define ARMONICOS 10
+
+#define LIMITE_CENTS 0.5               // afinación contra el temperamento igual
+#define TOLERANCIA_CENTS 0.02          // contra la referencia
+#define TOLERANCIA_DB 1.0              // THD y THD+N pueden empeorar hasta esto
+#define TOLERANCIA_FIN 48              // muestras; el inicio tiene que ser exacto
+
+struct Medida {
+    double hz = 0;
+    double thdDb = 0;
+    double thdnDb = 0;
+    long inicio = -1;     // muestras desde notaOn hasta la primera distinta de cero
+    long fin = -1;        // muestras desde notaOff hasta la última distinta de cero
+};
+
+const char* const nombresConfig[] = { "viva-flotante", "viva-q15", "cache-flotante", "cache-q15" };
+
+std::vector<double> renderizar(int nota, int config) {
+    Sintetizador sinte;
+    sinte.fijarModo(config >= 2 ? SINTESIS_CACHE : SINTESIS_VIVA);
+    sinte.fijarAritmetica(config % 2 ? ARITMETICA_Q15 : ARITMETICA_FLOTANTE);
+    LineaTiempo linea;
+    linea.agregar(INICIO_NOTA, nota, true);
+    linea.agregar(INICIO_NOTA + DURACION_NOTA, nota, false);
+    linea.ordenar();
+
+    std::vector<int16_t> buffer(TOTAL_MUESTRAS);
+    for (int reloj = 0; reloj < TOTAL_MUESTRAS; reloj += PERIODO)
+        linea.renderPeriodo(sinte, uint64_t(reloj), buffer.data() + reloj, std::min(PERIODO, TOTAL_MUESTRAS - reloj));
+    return std::vector<double>(buffer.begin(), buffer.end());
+}
+
+// Cruces por cero hacia arriba, interpolados: buena resolución para una
+// senoidal sola en medio segundo
+double fundamental(const double* x, int n) {
+    double primero = -1, ultimo = 0;
+    int ciclos = 0;
+    for (int i = 1; i < n; ++i) {
+        if (x[i - 1] < 0 && x[i] >= 0) {
+            double t = (i - 1) + -x[i - 1] / (x[i] - x[i - 1]);
+            if (primero < 0) primero = t;
+            else ++ciclos;
+            ultimo = t;
+        }
+    }
+    return ciclos > 0 ? ciclos * double(FRECUENCIA_MUESTREO) / (ultimo - primero) : 0;
+}
+
+// Amplitud en hz con ventana Hann (producto interno con seno y coseno)
+double amplitud(const double* x, const double* ventana, int n, double hz) {
+    double re = 0, im = 0;
+    double w = 2.0 * M_PI * hz / FRECUENCIA_MUESTREO;
+    for (int i = 0; i < n; ++i) {
+        re += x[i] * ventana[i] * std::cos(w * i);
+        im += x[i] * ventana[i] * std::sin(w * i);
+    }
+    return std::sqrt(re * re + im * im);
+}
+
+// Todo lo que queda al restar la senoidal que mejor ajusta (mínimos
+// cuadrados en la frecuencia medida), relativo a esa senoidal
+double thdn(const double* x, int n, double hz) {
+    double w = 2.0 * M_PI * hz / FRECUENCIA_MUESTREO;
+    double ss = 0, cc = 0, sc = 0, xs = 0, xc = 0;
+    for (int i = 0; i < n; ++i) {
+        double s = std::sin(w * i), c = std::cos(w * i);
+        ss += s * s; cc += c * c; sc += s * c;
+        xs += x[i] * s; xc += x[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (xs * cc - xc * sc) / det, b = (xc * ss - xs * sc) / det;
+    double senal = 0, resto = 0;
+    for (int i = 0; i < n; ++i) {
+        double ajuste = a * std::sin(w * i) + b * std::cos(w * i);
+        senal += ajuste * ajuste;
+        resto += (x[i] - ajuste) * (x[i] - ajuste);
+    }
+    return 10.0 * std::log10(resto / senal);
+}
+
+Medida medir(int nota, int config) {
+    std::vector<double> x = renderizar(nota, config);
+    const double* sostenido = x.data() + INICIO_NOTA + DESDE_ANALISIS;
+
+    Medida m;
+    m.hz = fundamental(sostenido, LARGO_ANALISIS);
+
+    std::vector<double> ventana(LARGO_ANALISIS);
+    for (int i = 0; i < LARGO_ANALISIS; ++i) ventana[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / (LARGO_ANALISIS - 1));
+    double base = amplitud(sostenido, ventana.data(), LARGO_ANALISIS, m.hz);
+    double armonicos = 0;
+    for (int k = 2; k <= ARMONICOS && k * m.hz < FRECUENCIA_MUESTREO / 2; ++k) {
+        double a = amplitud(sostenido, ventana.data(), LARGO_ANALISIS, k * m.hz);
+        armonicos += a * a;
+    }
+    m.thdDb = 10.0 * std::log10(armonicos / (base * base) + 1e-30);
+    m.thdnDb = thdn(sostenido, LARGO_ANALISIS, m.hz);
+
+    for (int i = 0; i < TOTAL_MUESTRAS; ++i)
+        if (x[i] != 0) {
+            m.inicio = i - INICIO_NOTA;
+            break;
+        }
+    for (int i = TOTAL_MUESTRAS - 1; i >= 0; --i)
+        if (x[i] != 0) {
+            m.fin = i - (INICIO_NOTA + DURACION_NOTA);
+            break;
+        }
+    return m;
+}
+
+double temperado(int nota) { return 440.0 * std::pow(2.0, (nota - 9) / 12.0); }
+double cents(double hz, double referencia) { return 1200.0 * std::log2(hz / referencia); }
+
+int main(int argc, char** argv) {
+    std::string ruta = "audio_referencia.txt";
+    bool actualizar = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--actualizar") actualizar = true;
+        else ruta = a;
+    }
+
+    std::vector<std::vector<Medida>> medidas(4, std::vector<Medida>(NUM_NOTAS));
+    for (int c = 0; c < 4; ++c)
+        for (int n = 0; n < NUM_NOTAS; ++n) medidas[c][n] = medir(n, c);
+
+    if (actualizar) {
+        std::ofstream f(ruta);
+        f << "# Referencia de prueba_audio; regenerar con ./prueba_audio --actualizar\n";
+        f << "# configuración nota hz thd_db thdn_db inicio fin\n";
+        f.setf(std::ios::fixed);
+        for (int c = 0; c < 4; ++c)
+            for (int n = 0; n < NUM_NOTAS; ++n) {
+                const Medida& m = medidas[c][n];
+                f.precision(4);
+                f << nombresConfig[c] << " " << nombresNotas[n] << " " << m.hz << " ";
+                f.precision(1);
+                f << m.thdDb << " " << m.thdnDb << " " << m.inicio << " " << m.fin << "\n";
+            }
+        std::cout << "Referencia guardada en " << ruta << "\n";
+        return f ? 0 : 1;
+    }
+
+    std::ifstream f(ruta);
+    if (!f) {
+        std::cerr << "No se pudo abrir " << ruta << " (se crea con --actualizar)\n";
+        return 1;
+    }
+    std::map<std::string, Medida> referencia;
+    std::string linea;
+    while (std::getline(f, linea)) {
+        if (linea.empty() || linea[0] == '#') continue;
+        std::istringstream ss(linea);
+        std::string config, nota;
+        Medida m;
+        if (ss >> config >> nota >> m.hz >> m.thdDb >> m.thdnDb >> m.inicio >> m.fin) referencia[config + " " + nota] = m;
+    }
+
+    int fallas = 0;
+    for (int c = 0; c < 4; ++c) {
+        double peorCents = 0, peorThd = -200, peorThdn = -200;
+        for (int n = 0; n < NUM_NOTAS; ++n) {
+            const Medida& m = medidas[c][n];
+            std::string clave = std::string(nombresConfig[c]) + " " + nombresNotas[n];
+            auto r = referencia.find(clave);
+            std::vector<std::string> problemas;
+            double desafinacion = cents(m.hz, temperado(n));
+            if (std::fabs(desafinacion) > LIMITE_CENTS) problemas.push_back("desafinada " + std::to_string(desafinacion) + " cents");
+            if (r == referencia.end()) {
+                problemas.push_back("sin referencia");
+            } else {
+                const Medida& g = r->second;
+                if (std::fabs(cents(m.hz, g.hz)) > TOLERANCIA_CENTS) problemas.push_back("frecuencia " + std::to_string(m.hz) + " Hz, referencia " + std::to_string(g.hz));
+                if (m.thdDb > g.thdDb + TOLERANCIA_DB) problemas.push_back("THD " + std::to_string(m.thdDb) + " dB, referencia " + std::to_string(g.thdDb));
+                if (m.thdnDb > g.thdnDb + TOLERANCIA_DB) problemas.push_back("THD+N " + std::to_string(m.thdnDb) + " dB, referencia " + std::to_string(g.thdnDb));
+                if (m.inicio != g.inicio) problemas.push_back("empieza en " + std::to_string(m.inicio) + ", referencia " + std::to_string(g.inicio));
+                if (std::labs(m.fin - g.fin) > TOLERANCIA_FIN) problemas.push_back("termina en " + std::to_string(m.fin) + ", referencia " + std::to_string(g.fin));
+            }
+            for (const auto& p : problemas) std::cout << "FALLA " << clave << ": " << p << "\n";
+            fallas += int(problemas.size());
+            peorCents = std::max(peorCents, std::fabs(desafinacion));
+            peorThd = std::max(peorThd, m.thdDb);
+            peorThdn = std::max(peorThdn, m.thdnDb);
+        }
+        std::cout << nombresConfig[c] << ": peor afinación " << peorCents << " cents, peor THD " << peorThd
+                  << " dB, peor THD+N " << peorThdn << " dB\n";
+    }
+
+    std::cout << (fallas ? "El sonido cambió respecto de la referencia\n" : "Sonido igual a la referencia\n");
+    return fallas ? 1 : 0;
+}
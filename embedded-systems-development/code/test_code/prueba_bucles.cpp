@@ -0,0 +1,55 @@
+#include <iostream>
+#include <cmath>
+#include "../piano/sintetizador.h"
+
+// Comprueba que los bucles de la cache no hacen clic al volver al inicio.
+// Cada nota se toca sola en modo cache durante varios recorridos del bucle;
+// un salto en el empalme aparece como una segunda diferencia mucho mayor que
+// la de una senoidal limpia, A * (2 pi f / fs)^2. También revisa que la
+// desafinación del bucle quede dentro de la tolerancia.
+
+#define PERIODO 256
+#define SEGUNDOS 2
+
+int main() {
+    const CacheBucles& cache = CacheBucles::global();
+    const double amplitud = GANANCIA_VOZ * 32767.0;
+    const double ruido = 3.0;   // redondeo a int16 en tres muestras
+    bool ok = true;
+
+    for (int n = 0; n < NUM_NOTAS; ++n) {
+        Sintetizador sinte;
+        sinte.fijarModo(SINTESIS_CACHE);
+        // Sin ataque ni decaimiento: solo se mide el bucle, a volumen pleno
+        sinte.fijarEnvolvente({0.0f, 0.0f, 1.0f, RELAJACION_MS});
+        sinte.notaOn(n);
+
+        int total = SEGUNDOS * FRECUENCIA_MUESTREO;
+        int16_t buffer[PERIODO];
+        double a = 0, b = 0, peor = 0;
+        int hechas = 0;
+        while (hechas < total) {
+            sinte.render(buffer, PERIODO);
+            for (int i = 0; i < PERIODO; ++i, ++hechas) {
+                double x = buffer[i];
+                if (hechas >= 2) peor = std::max(peor, std::fabs(x - 2 * b + a));
+                a = b;
+                b = x;
+            }
+        }
+
+        double real = double(cache.ciclos(n)) * FRECUENCIA_MUESTREO / cache.largo(n);
+        double cents = 1200.0 * std::log2(real / frecuencias[n]);
+        double w = 2.0 * M_PI * real / FRECUENCIA_MUESTREO;
+        double limite = amplitud * w * w + ruido;
+        bool nota = peor <= limite && std::fabs(cents) <= TOLERANCIA_BUCLE_CENTS;
+        ok = ok && nota;
+
+        std::cout << nombresNotas[n] << ": bucle " << cache.largo(n) << " muestras, " << cache.ciclos(n)
+                  << " ciclos, " << cents << " cents, segunda diferencia " << peor << " (límite " << limite << ") "
+                  << (nota ? "ok" : "FALLA") << "\n";
+    }
+
+    std::cout << (ok ? "Sin clics en los empalmes\n" : "Hay notas con clic o desafinadas\n");
+    return ok ? 0 : 1;
+}
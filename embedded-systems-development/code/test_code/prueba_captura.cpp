@@ -0,0 +1,134 @@
+#include <gpiod.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../piano/matriz.h"
+#include "../piano/captura.h"
+
+#ifndef GPIO_SIMULADO
+#error "Compilar con -I../simulador para usar el GPIO simulado"
+#endif
+
+// Ida y vuelta de piano/captura.h con el GPIO simulado y reloj virtual:
+//  - se escanea un toque al azar como main_menu y se captura a un archivo
+//  - el archivo se lee con los mismos escaneos y tiempos (al microsegundo)
+//  - reproducido en el simulador, a la velocidad original y cuatro veces más
+//    rápido, el escaneo vuelve a leer exactamente las mismas teclas
+//  - lineaDeCaptura da un evento por cada cambio, como escanearYTocar
+//
+// Uso: g++ -I../simulador prueba_captura.cpp -o prueba_captura -pthread && ./prueba_captura
+
+#define TICK_US 5000
+#define TOQUES 40          // unos 700 escaneos, entran en el anillo de una vez
+#define ARCHIVO "prueba_captura.teclas"
+
+int fallas = 0;
+
+void revisar(bool ok, const std::string& que) {
+    if (ok) return;
+    std::cout << "FALLA " << que << "\n";
+    ++fallas;
+}
+
+// Escanea cada tick desde "desdeUs" hasta "hastaUs", con el tiempo de la placa
+std::vector<MuestraEscaneo> escanear(Matriz& matriz, uint64_t desdeUs, uint64_t hastaUs) {
+    PlacaSimulada& placa = PlacaSimulada::global();
+    if (desdeUs > placa.ahoraUs()) placa.esperar(desdeUs - placa.ahoraUs());
+    std::vector<MuestraEscaneo> leidas;
+    while (placa.ahoraUs() < hastaUs) {
+        uint64_t inicio = placa.ahoraUs();
+        leidas.push_back({inicio * 1000, matriz.escanear()});
+        placa.esperar(TICK_US - (placa.ahoraUs() - inicio));
+    }
+    return leidas;
+}
+
+// Mismas teclas escaneo por escaneo
+bool iguales(const std::vector<MuestraEscaneo>& a, const std::vector<MuestraEscaneo>& b, std::string& diferencia) {
+    if (a.size() != b.size()) {
+        diferencia = std::to_string(a.size()) + " escaneos contra " + std::to_string(b.size());
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].teclas != b[i].teclas) {
+            diferencia = "escaneo " + std::to_string(i) + ": " + std::to_string(a[i].teclas) + " contra " + std::to_string(b[i].teclas);
+            return false;
+        }
+    return true;
+}
+
+int main() {
+    PlacaSimulada& placa = PlacaSimulada::global();
+    placa.usarRelojVirtual(true);
+    Matriz matriz;
+    revisar(matriz.abrir("prueba"), "abrir la matriz");
+
+    // Toques al azar de 20 a 300 ms, a veces encimados
+    unsigned semilla = 11;
+    uint64_t t = 10000;
+    for (int i = 0; i < TOQUES; ++i) {
+        uint64_t dura = 20000 + rand_r(&semilla) % 280000;
+        placa.apretar(rand_r(&semilla) % NUM_NOTAS, t, t + dura);
+        t += rand_r(&semilla) % 150000;
+    }
+    uint64_t fin = t + 400000;
+
+    CapturaTeclado captura;
+    revisar(captura.abrir(ARCHIVO), "abrir " ARCHIVO);
+    std::vector<MuestraEscaneo> originales = escanear(matriz, placa.ahoraUs(), fin);
+    for (const auto& m : originales) captura.registrar(m.ns, m.teclas);
+    captura.cerrar();
+    revisar(captura.escaneosDescartados() == 0, std::to_string(captura.escaneosDescartados()) + " escaneos descartados");
+
+    std::vector<MuestraEscaneo> leidas;
+    revisar(leerCaptura(ARCHIVO, leidas), "leer " ARCHIVO);
+    revisar(leidas.size() == originales.size(), "el archivo tiene " + std::to_string(leidas.size()) + " escaneos de " +
+                                                    std::to_string(originales.size()));
+    for (size_t i = 0; i < leidas.size() && i < originales.size(); ++i) {
+        revisar(leidas[i].ns == originales[i].ns && leidas[i].teclas == originales[i].teclas,
+                "escaneo " + std::to_string(i) + " cambió al guardarlo");
+        if (leidas[i].ns != originales[i].ns || leidas[i].teclas != originales[i].teclas) break;
+    }
+
+    uint32_t antes = 0;
+    int cambios = 0;
+    for (const auto& m : leidas) {
+        cambios += __builtin_popcount(m.teclas ^ antes);
+        antes = m.teclas;
+    }
+    cambios += __builtin_popcount(antes);
+    LineaTiempo linea;
+    int notas = lineaDeCaptura(ARCHIVO, linea);
+    revisar(notas > 0, "lineaDeCaptura no encontró notas");
+    int eventos = int(linea.lista().size());
+    revisar(eventos == cambios, std::to_string(eventos) + " eventos para " + std::to_string(cambios) + " cambios");
+
+    // Reproducida: sin el guion original, en la misma fase respecto de los
+    // escaneos, tiene que leerse lo mismo
+    std::string diferencia;
+    for (double velocidad : {1.0, 4.0}) {
+        PlacaSimulada& p = PlacaSimulada::global();
+        uint64_t base = (p.ahoraUs() / TICK_US + 100) * TICK_US;
+        uint64_t dura = uint64_t(double(leidas.back().ns - leidas.front().ns) / 1000.0 / velocidad);
+        p.reproducirCaptura(leidas, base, velocidad);
+        std::vector<MuestraEscaneo> otra;
+        if (velocidad == 1.0) {
+            otra = escanear(matriz, base, base + dura + 1);
+        } else {
+            // Cada escaneo en el tiempo comprimido del original
+            for (size_t i = 0; i < leidas.size(); ++i) {
+                uint64_t en = base + uint64_t(double(leidas[i].ns - leidas.front().ns) / 1000.0 / velocidad);
+                p.esperar(en - p.ahoraUs());
+                otra.push_back({en * 1000, matriz.escanear()});
+            }
+        }
+        bool ok = iguales(leidas, otra, diferencia);
+        revisar(ok, "reproducción x" + std::to_string(int(velocidad)) + ": " + diferencia);
+    }
+
+    matriz.cerrar();
+    remove(ARCHIVO);
+    std::cout << leidas.size() << " escaneos, " << notas << " notas, " << eventos << " eventos\n";
+    std::cout << (fallas ? "Hubo fallas\n" : "Captura y reproducción bien\n");
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include "../piano/motor_audio.h"
+
+// Prueba el control de carga del audio (piano/carga_audio.h):
+//  - con carga alta baja de nivel en orden, un paso cada PERIODOS_ENTRE_PASOS,
+//    y nunca pasa del último nivel; un periodo tarde degrada enseguida
+//  - entre CARGA_BAJA y CARGA_ALTA no cambia, y con la carga baja vuelve de a
+//    un nivel cada RECUPERAR_MS
+//  - limitarVoces apaga las que sobran (las más viejas) sin clic y las notas
+//    nuevas respetan el tope; una voz que apaga la cola de un robo se quita
+//    cuando termina esa cola
+//  - en el MotorAudio, un observador que tarda más que el periodo se deja de
+//    llamar, y vuelve cuando la carga baja; cada paso se cuenta y se registra
+//
+// Uso: g++ prueba_carga.cpp -o prueba_carga -lasound -lpthread
+//      ./prueba_carga [--dispositivo X]   (por defecto "null")
+
+#define PERIODO 256
+#define VOCES 12
+#define REGISTRO "prueba_carga.log"
+
+int fallas = 0;
+std::atomic<uint64_t> llamadas{0};
+std::atomic<uint64_t> llamadasDegradado{0};
+
+void revisar(bool ok, const std::string& que) {
+    if (ok) return;
+    std::cout << "FALLA " << que << "\n";
+    ++fallas;
+}
+
+// Periodos hasta que observar() pida un cambio, con la misma carga
+int hastaCambio(ControlCarga& c, uint32_t carga, int maximo, int& cambio) {
+    for (int p = 1; p <= maximo; ++p)
+        if ((cambio = c.observar(carga)) != 0) return p;
+    cambio = 0;
+    return -1;
+}
+
+void tocarMs(Sintetizador& sinte, double ms, double* peorSalto = nullptr) {
+    static double a = 0, b = 0;
+    int16_t buffer[PERIODO];
+    long total = long(ms * FRECUENCIA_MUESTREO / 1000);
+    for (long hechas = 0; hechas < total; hechas += PERIODO) {
+        int frames = int(std::min<long>(PERIODO, total - hechas));
+        sinte.render(buffer, frames);
+        for (int i = 0; i < frames; ++i) {
+            double x = buffer[i];
+            if (peorSalto) *peorSalto = std::max(*peorSalto, std::fabs(x - 2 * b + a));
+            a = b;
+            b = x;
+        }
+    }
+}
+
+// En el hilo de audio: hasta la primera degradación tarda un periodo y
+// medio. El nivel se publica en el mismo hilo antes del periodo siguiente,
+// así que con el nivel puesto no debería llamarse.
+void observar(const int16_t*, int frames, void*) {
+    llamadas.fetch_add(1, std::memory_order_relaxed);
+    if (metricas.nivelCarga.leer() != CARGA_NORMAL) llamadasDegradado.fetch_add(1, std::memory_order_relaxed);
+    if (metricas.sinObservador.leer() > 0) return;
+    uint64_t hasta = ahoraNs() + uint64_t(frames) * 1500000000ull / FRECUENCIA_MUESTREO;
+    while (ahoraNs() < hasta) {
+    }
+}
+
+template <typename F>
+bool esperar(F&& listo, int ms) {
+    for (int i = 0; i < ms && !listo(); ++i) usleep(1000);
+    return listo();
+}
+
+int main(int argc, char** argv) {
+    // Los niveles con 12 voces: tres sin quitar voces, luego de a dos hasta 4
+    const int vocesEsperadas[] = { 12, 12, 12, 10, 8, 6, 4 };
+    int maximo = nivelMaximoCarga(VOCES);
+    revisar(maximo == 6, "con " + std::to_string(VOCES) + " voces el último nivel es " + std::to_string(maximo));
+    for (int n = 0; n <= maximo; ++n)
+        revisar(vocesEnNivel(n, VOCES) == vocesEsperadas[n], "nivel " + std::to_string(n) + ": " +
+                                                               std::to_string(vocesEnNivel(n, VOCES)) + " voces");
+    revisar(nivelMaximoCarga(2) == CARGA_SINTESIS_CACHE, "con 2 voces no se quitan voces");
+
+    double periodoUs = PERIODO * 1e6 / FRECUENCIA_MUESTREO;
+    int recuperar = int(RECUPERAR_MS * 1000.0 / periodoUs) + 1;
+    ControlCarga control;
+    control.iniciar(maximo, periodoUs);
+    int cambio;
+    revisar(hastaCambio(control, 300, 1000, cambio) < 0, "con 30% cambió de nivel");
+    revisar(control.observar(1100) == 1 && control.nivel() == CARGA_SIN_OBSERVADOR, "un periodo tarde no degradó enseguida");
+    // La media tarda en subir; después es un paso cada PERIODOS_ENTRE_PASOS
+    hastaCambio(control, 900, 100, cambio);
+    revisar(cambio == 1 && control.nivel() == CARGA_SINTESIS_CACHE, "con 90% no bajó a " + std::string(nombreNivelCarga(2)));
+    for (int n = CARGA_MENOS_VOCES; n <= maximo; ++n) {
+        int p = hastaCambio(control, 900, 100, cambio);
+        revisar(p == PERIODOS_ENTRE_PASOS && cambio == 1 && control.nivel() == n,
+                "al nivel " + std::to_string(n) + " en " + std::to_string(p) + " periodos");
+    }
+    revisar(hastaCambio(control, 1500, 1000, cambio) < 0, "bajó más allá del último nivel");
+    revisar(hastaCambio(control, 600, 3 * recuperar, cambio) < 0, "entre los umbrales cambió de nivel");
+    for (int n = maximo - 1; n >= CARGA_NORMAL; --n) {
+        int p = hastaCambio(control, 200, 2 * recuperar, cambio);
+        revisar(cambio == -1 && control.nivel() == n && std::abs(p - recuperar) <= PESO_MEDIA_CARGA,
+                "volver al nivel " + std::to_string(n) + " tomó " + std::to_string(p) + " periodos");
+    }
+    revisar(control.vecesDegradado() == uint64_t(maximo) && control.vecesRecuperado() == uint64_t(maximo) &&
+                control.periodosTarde() == 1001,
+            "se contaron " + std::to_string(control.vecesDegradado()) + " degradaciones, " +
+                std::to_string(control.vecesRecuperado()) + " recuperaciones y " +
+                std::to_string(control.periodosTarde()) + " periodos tarde");
+
+    // Ocho notas y tope de cuatro: se apagan las cuatro más viejas
+    {
+        Sintetizador sinte;
+        for (int n = 0; n < 8; ++n) {
+            sinte.notaOn(n);
+            tocarMs(sinte, 2);
+        }
+        sinte.limitarVoces(4);
+        tocarMs(sinte, 10);
+        bool viejas = sinte.vocesActivas() == 4;
+        for (int n = 0; n < 8; ++n) viejas = viejas && sinte.sonando(n) == (n >= 4);
+        revisar(viejas, "con tope de 4 quedaron " + std::to_string(sinte.vocesActivas()) + " voces, no las 4 más nuevas");
+        revisar(sinte.vocesQuitadas() == 4 && sinte.robos() == 0,
+                "se contaron " + std::to_string(sinte.vocesQuitadas()) + " voces quitadas y " + std::to_string(sinte.robos()) + " robos");
+        sinte.notaOn(10);
+        sinte.notaOn(11);
+        tocarMs(sinte, 10);
+        revisar(sinte.vocesActivas() == 4 && sinte.sonando(10) && sinte.sonando(11), "las notas nuevas pasaron el tope");
+        sinte.limitarVoces(VOCES);
+        for (int n = 12; n < 20; ++n) sinte.notaOn(n);
+        tocarMs(sinte, 10);
+        revisar(sinte.vocesActivas() == VOCES, "sin tope suenan " + std::to_string(sinte.vocesActivas()) + " voces");
+    }
+
+    // Quitar una de dos voces agudas no hace clic (el límite de prueba_robo)
+    {
+        Sintetizador sinte;
+        double peor = 0;
+        tocarMs(sinte, 10);
+        sinte.notaOn(NUM_NOTAS - 1);
+        sinte.notaOn(NUM_NOTAS - 2);
+        tocarMs(sinte, 50, &peor);
+        sinte.limitarVoces(1);
+        tocarMs(sinte, 20, &peor);
+        double amplitud = GANANCIA_VOZ * 32767.0;
+        double w = 2.0 * M_PI * frecuencias[NUM_NOTAS - 1] / FRECUENCIA_MUESTREO;
+        double rampas = 1000.0 / (ATAQUE_MS * FRECUENCIA_MUESTREO) + 1000.0 / (ROBO_MS * FRECUENCIA_MUESTREO);
+        double limiteSalto = amplitud * (2 * w * w + rampas * (1 + 2 * w)) + 3.0;
+        revisar(peor <= limiteSalto && sinte.vocesActivas() == 1,
+                "mayor segunda diferencia " + std::to_string(peor) + " (límite " + std::to_string(limiteSalto) + ")");
+    }
+
+    // Con las dos voces apagando la cola de un robo no se quita ninguna hasta
+    // que una cola termina, y entonces tampoco hay clic
+    {
+        Sintetizador sinte;
+        sinte.fijarPolifonia(2, ROBAR_VIEJA);
+        double peor = 0;
+        tocarMs(sinte, 10);
+        sinte.notaOn(NUM_NOTAS - 1);
+        sinte.notaOn(NUM_NOTAS - 2);
+        tocarMs(sinte, 50, &peor);
+        sinte.notaOn(NUM_NOTAS - 3);
+        sinte.notaOn(NUM_NOTAS - 4);
+        tocarMs(sinte, 1, &peor);
+        sinte.limitarVoces(1);
+        bool espera = sinte.vocesQuitadas() == 0;
+        tocarMs(sinte, 20, &peor);
+        double amplitud = GANANCIA_VOZ * 32767.0;
+        double w = 2.0 * M_PI * frecuencias[NUM_NOTAS - 1] / FRECUENCIA_MUESTREO;
+        double rampas = 1000.0 / (ATAQUE_MS * FRECUENCIA_MUESTREO) + 1000.0 / (ROBO_MS * FRECUENCIA_MUESTREO);
+        double limiteSalto = amplitud * (2 * w * w + 2 * rampas * (1 + 2 * w)) + 3.0;
+        revisar(espera && sinte.vocesQuitadas() == 1 && sinte.vocesActivas() == 1,
+                "con las colas ocupadas se quitaron " + std::to_string(sinte.vocesQuitadas()) + " voces y quedan " +
+                    std::to_string(sinte.vocesActivas()));
+        revisar(peor <= limiteSalto, "quitando con las colas ocupadas, mayor segunda diferencia " + std::to_string(peor) +
+                                         " (límite " + std::to_string(limiteSalto) + ")");
+    }
+
+    // El MotorAudio deja el observador lento y lo retoma
+    Registro::global().iniciar(REGISTRO);
+    ConfigAlsa alsa;
+    alsa.dispositivo = "null";
+    alsa.periodo = PERIODO;
+    leerConfigAlsa(argc, argv, alsa);
+    MotorAudio audio;
+    audio.observar(observar, nullptr);
+    if (!audio.abrir(alsa)) return 1;
+    // Con un dispositivo que no lleva el ritmo (el "null") todo esto pasa
+    // en mucho menos que RECUPERAR_MS
+    revisar(esperar([] { return metricas.sinObservador.leer() > 0; }, 2000), "el observador lento no se dejó");
+    revisar(esperar([] { return metricas.recuperaciones.leer() > 0; }, RECUPERAR_MS * 2), "no se recuperó con la carga baja");
+    uint64_t vistas = llamadas.load();
+    revisar(esperar([&] { return llamadas.load() > vistas; }, 1000), "el observador no volvió");
+    audio.cerrar();
+    revisar(metricas.sinObservador.leer() == 1 && metricas.sintesisCache.leer() == 0 && metricas.menosVoces.leer() == 0,
+            "sin el observador siguió degradando");
+    revisar(llamadasDegradado.load() == 0,
+            "se llamó " + std::to_string(llamadasDegradado.load()) + " veces al observador con el audio degradado");
+    Registro::global().detener();
+
+    std::ifstream archivo(REGISTRO);
+    std::stringstream texto;
+    texto << archivo.rdbuf();
+    revisar(texto.str().find("nivel de carga 1 (sin observador)") != std::string::npos &&
+                texto.str().find("nivel de carga 0 (normal)") != std::string::npos,
+            "el registro no tiene los cambios de nivel");
+    remove(REGISTRO);
+    audio.imprimirEstadisticas();
+
+    std::cout << (fallas ? "Hubo fallas\n" : "Control de carga bien\n");
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cmath>
+#include "../piano/sintetizador.h"
+#include "../piano/linea_tiempo.h"
+
+// Comprueba la envolvente con una nota A4 que empieza y termina a mitad de
+// periodo: el sonido arranca en la muestra exacta del evento, la voz se
+// libera justo al terminar la relajación y no hay saltos (clics) ni al
+// empezar ni al soltar. Para comparar, mide el mismo corte sin relajación,
+// que es lo que pasaba al matar el proceso de la nota.
+
+#define PERIODO 256
+#define NOTA 9                 // A4
+#define INICIO 1037
+#define DURACION 4800
+
+struct Resultado {
+    long primera = -1;         // primera muestra distinta de cero
+    long ultima = -1;          // última muestra distinta de cero
+    long liberada = -1;        // primer periodo que termina sin voces
+    double peorSalto = 0;      // mayor segunda diferencia
+};
+
+Resultado tocar(const Envolvente& env) {
+    Sintetizador sinte;
+    sinte.fijarEnvolvente(env);
+    LineaTiempo linea;
+    linea.agregar(INICIO, NOTA, true);
+    linea.agregar(INICIO + DURACION, NOTA, false);
+    linea.ordenar();
+
+    Resultado r;
+    int16_t buffer[PERIODO];
+    double a = 0, b = 0;
+    long total = INICIO + DURACION + long(env.relajacionMs * FRECUENCIA_MUESTREO / 1000) + 4 * PERIODO;
+    for (long reloj = 0; reloj < total; reloj += PERIODO) {
+        linea.renderPeriodo(sinte, uint64_t(reloj), buffer, PERIODO);
+        for (int i = 0; i < PERIODO; ++i) {
+            long n = reloj + i;
+            if (buffer[i] != 0) {
+                if (r.primera < 0) r.primera = n;
+                r.ultima = n;
+            }
+            double x = buffer[i];
+            if (n >= 2) r.peorSalto = std::max(r.peorSalto, std::fabs(x - 2 * b + a));
+            a = b;
+            b = x;
+        }
+        if (r.liberada < 0 && reloj > INICIO && sinte.vocesActivas() == 0) r.liberada = reloj + PERIODO;
+    }
+    return r;
+}
+
+int main() {
+    Envolvente env;
+    Resultado r = tocar(env);
+    Resultado corte = tocar({0.0f, 0.0f, 1.0f, 0.0f});
+
+    double w = 2.0 * M_PI * frecuencias[NOTA] / FRECUENCIA_MUESTREO;
+    double amplitud = GANANCIA_VOZ * 32767.0;
+    // Senoidal limpia más lo que agrega la rampa más rápida (el ataque): su
+    // pendiente y el quiebre al llegar arriba. Más el redondeo.
+    double rampa = 1000.0 / (env.ataqueMs * FRECUENCIA_MUESTREO);
+    double limite = amplitud * (w * w + rampa * (1 + 2 * w)) + 3.0;
+    long finRelajacion = INICIO + DURACION + long(std::ceil(env.relajacionMs * FRECUENCIA_MUESTREO / 1000));
+
+    bool inicioOk = r.primera == INICIO;
+    bool finOk = r.ultima < finRelajacion && r.ultima > INICIO + DURACION;
+    bool liberadaOk = r.liberada >= 0 && r.liberada - finRelajacion < PERIODO;
+    bool suaveOk = r.peorSalto <= limite;
+
+    std::cout << "Primera muestra con sonido: " << r.primera << " (evento en " << INICIO << ") "
+              << (inicioOk ? "ok" : "FALLA") << "\n";
+    std::cout << "Última muestra con sonido: " << r.ultima << " (relajación termina en " << finRelajacion << ") "
+              << (finOk ? "ok" : "FALLA") << "\n";
+    std::cout << "Voz liberada al terminar el periodo " << r.liberada << " "
+              << (liberadaOk ? "ok" : "FALLA") << "\n";
+    std::cout << "Mayor segunda diferencia con envolvente: " << r.peorSalto << " (límite " << limite << ") "
+              << (suaveOk ? "ok" : "FALLA") << "\n";
+    std::cout << "Mayor segunda diferencia cortando en seco: " << corte.peorSalto << "\n";
+
+    bool ok = inicioOk && finOk && liberadaOk && suaveOk;
+    std::cout << (ok ? "Envolvente sin clics y en la muestra exacta\n" : "La envolvente falla\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include <gpiod.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../piano/matriz.h"
+#include "../tutor/canciones.h"
+
+#ifndef GPIO_SIMULADO
+#error "Compilar con -I../simulador para usar el GPIO simulado"
+#endif
+
+// Prueba el escaneo y los LEDs contra el modelo de simulador/gpiod.h, con
+// reloj virtual: todo corre en milisegundos y da siempre lo mismo.
+//  - cada tecla sola y acordes al azar se leen exactos
+//  - encenderLed enciende solo ese LED y apagarLeds los apaga todos
+//  - una tecla se detecta y se suelta dentro de un escaneo más un tick
+//  - estrellita completa con el criterio del tutor: el LED de la nota que
+//    sigue, verificado con el guion, y la tecla correcta lo hace avanzar
+//  - los botones del guion y que una línea no se pueda pedir dos veces
+//
+// Uso: g++ -I../simulador prueba_matriz.cpp -o prueba_matriz && ./prueba_matriz
+
+#define TICK_US 5000
+#define ACORDES 500
+#define PASO_CANCION_US 300000
+#define APRETADA_US 150000
+
+int fallas = 0;
+
+void revisar(bool ok, const std::string& que) {
+    if (ok) return;
+    std::cout << "FALLA " << que << "\n";
+    ++fallas;
+}
+
+// Escanea cada tick hasta "hastaUs"; devuelve cuándo empezó el primer
+// escaneo que vio la nota y el primero que ya no la vio
+void detectar(Matriz& matriz, int nota, uint64_t hastaUs, uint64_t& vista, uint64_t& soltada) {
+    PlacaSimulada& placa = PlacaSimulada::global();
+    vista = soltada = 0;
+    while (placa.ahoraUs() < hastaUs) {
+        uint64_t inicio = placa.ahoraUs();
+        bool apretada = matriz.escanear() & (1u << nota);
+        if (apretada && !vista) vista = inicio;
+        if (!apretada && vista && !soltada) soltada = inicio;
+        placa.esperar(TICK_US);
+    }
+}
+
+int main() {
+    auto reloj = std::chrono::steady_clock::now();
+    PlacaSimulada& placa = PlacaSimulada::global();
+    placa.usarRelojVirtual(true);
+
+    Matriz matriz;
+    revisar(matriz.abrir("prueba"), "abrir la matriz");
+    Matriz otra;
+    revisar(!otra.abrir("otra"), "las líneas se pudieron pedir dos veces");
+
+    for (int n = 0; n < NUM_NOTAS; ++n) {
+        placa.fijarTeclas(1u << n);
+        uint32_t leidas = matriz.escanear();
+        revisar(leidas == 1u << n, std::string("tecla ") + nombresNotas[n] + " leída como " + std::to_string(leidas));
+    }
+    unsigned semilla = 7;
+    for (int i = 0; i < ACORDES; ++i) {
+        uint32_t acorde = uint32_t(rand_r(&semilla)) & ((1u << NUM_NOTAS) - 1);
+        placa.fijarTeclas(acorde);
+        uint32_t leidas = matriz.escanear();
+        revisar(leidas == acorde, "acorde " + std::to_string(acorde) + " leído como " + std::to_string(leidas));
+    }
+    placa.fijarTeclas(0);
+
+    for (int n = 0; n < NUM_NOTAS; ++n) {
+        matriz.encenderLed(n);
+        revisar(placa.leds() == 1u << n, std::string("LED de ") + nombresNotas[n] + ": " + std::to_string(placa.leds()));
+    }
+    matriz.apagarLeds();
+    revisar(placa.leds() == 0, "apagarLeds dejó LEDs encendidos");
+
+    // Cuánto dura un escaneo contando solo las pausas de Matriz
+    uint64_t antes = placa.ahoraUs();
+    matriz.escanear();
+    uint64_t escaneo = placa.ahoraUs() - antes;
+
+    // Una tecla de 20 ms se ve y se suelta dentro de un escaneo más un tick.
+    // Dos corridas que arrancan en la misma fase respecto de la tecla tienen
+    // que dar exactamente los mismos tiempos.
+    uint64_t vistas[2], soltadas[2];
+    for (int vez = 0; vez < 2; ++vez) {
+        uint64_t base = placa.ahoraUs();
+        placa.apretar(12, base + 10000, base + 30000);
+        detectar(matriz, 12, base + 60000, vistas[vez], soltadas[vez]);
+        revisar(vistas[vez] && soltadas[vez], "C5 no se vio o no se soltó");
+        vistas[vez] -= base;
+        soltadas[vez] -= base;
+        revisar(vistas[vez] >= 10000 - escaneo && vistas[vez] <= 10000 + escaneo + TICK_US, "C5 vista a los " + std::to_string(vistas[vez]) + " us");
+        revisar(soltadas[vez] >= 30000 - escaneo && soltadas[vez] <= 30000 + escaneo + TICK_US, "C5 soltada a los " + std::to_string(soltadas[vez]) + " us");
+    }
+    revisar(vistas[0] == vistas[1] && soltadas[0] == soltadas[1], "dos corridas iguales dieron tiempos distintos");
+
+    // Estrellita con el criterio del tutor: el LED marca la nota esperada y
+    // la tecla correcta pasa a la siguiente
+    const std::vector<std::string>& notas = estrellita.notas;
+    uint64_t inicio = placa.ahoraUs() + PASO_CANCION_US;
+    for (size_t i = 0; i < notas.size(); ++i) {
+        uint64_t t = inicio + i * PASO_CANCION_US;
+        placa.esperarLeds(t - PASO_CANCION_US / 2, 1u << indiceNota(notas[i]));
+        placa.apretar(indiceNota(notas[i]), t, t + APRETADA_US);
+    }
+    uint64_t fin = inicio + notas.size() * PASO_CANCION_US;
+    placa.esperarLeds(fin, 0);
+
+    size_t indice = 0;
+    uint32_t teclasAntes = 0;
+    matriz.encenderLed(indiceNota(notas[0]));
+    while (placa.ahoraUs() < fin + PASO_CANCION_US) {
+        uint32_t teclas = matriz.escanear();
+        if (indice < notas.size() && (teclas & ~teclasAntes & (1u << indiceNota(notas[indice])))) {
+            if (++indice < notas.size()) matriz.encenderLed(indiceNota(notas[indice]));
+            else matriz.apagarLeds();
+        }
+        teclasAntes = teclas;
+        placa.esperar(TICK_US);
+    }
+    revisar(indice == notas.size(), "estrellita quedó en la nota " + std::to_string(indice) + " de " + std::to_string(notas.size()));
+    int verificadas = placa.verificacionesHechas();
+    revisar(verificadas == int(notas.size()) + 1, "se hicieron " + std::to_string(verificadas) + " verificaciones de LEDs");
+    for (const auto& f : placa.fallas()) revisar(false, f);
+
+    // Botones: la línea se pide como entrada y sigue al guion
+    gpiod_chip* chip = gpiod_chip_open_by_name(CHIPNAME);
+    gpiod_line* ent = gpiod_chip_get_line(chip, PIN_ENT);
+    revisar(gpiod_line_request_input(ent, "prueba") == 0, "pedir ENT");
+    uint64_t boton = placa.ahoraUs();
+    placa.apretarBoton(PIN_ENT, boton + 1000, boton + 2000);
+    placa.esperar(1500);
+    revisar(gpiod_line_get_value(ent) == 1, "ENT no aparece apretado");
+    placa.esperar(1000);
+    revisar(gpiod_line_get_value(ent) == 0, "ENT no aparece suelto");
+
+    matriz.cerrar();
+    double realMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reloj).count();
+    std::cout << "Escaneo de " << escaneo << " us; C5 vista a los " << vistas[0] / 1000.0 << " ms y soltada a los "
+              << soltadas[0] / 1000.0 << " ms; estrellita: " << notas.size() << " notas\n";
+    std::cout << placa.ahoraUs() / 1000 << " ms simulados en " << realMs << " ms\n";
+    std::cout << (fallas ? "Hubo fallas\n" : "Matriz simulada bien\n");
+    return fallas ? 1 : 0;
+}
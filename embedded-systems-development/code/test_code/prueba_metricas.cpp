@@ -0,0 +1,110 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../piano/metricas.h"
+
+// Prueba piano/metricas.h sin el piano:
+//  - contadores, medidores e histogramas con escala, en el formato de
+//    Prometheus (cubetas acumuladas, _sum y _count)
+//  - cuatro hilos observando a la vez no pierden ninguna observación
+//  - el socket contesta solo el texto, o con cabecera HTTP si se pide "GET"
+//  - un archivo que no es socket en la ruta no se borra
+//
+// Uso: g++ prueba_metricas.cpp -o prueba_metricas -lpthread && ./prueba_metricas
+
+#define SOCKET_PRUEBA "/tmp/prueba_metricas.sock"
+#define HILOS 4
+#define OBSERVACIONES 100000
+
+Contador contador{"prueba_total", "Un contador"};
+Medidor medidor{"prueba_medidor", "Un medidor", 1000};
+Histograma histograma{"prueba_segundos", "Un histograma", {1000000, 5000000}, 1e9};
+Histograma compartido{"prueba_hilos", "Observado desde varios hilos", {10, 100}};
+
+int fallas = 0;
+
+void revisar(bool ok, const std::string& que) {
+    if (ok) return;
+    std::cout << "FALLA " << que << "\n";
+    ++fallas;
+}
+
+void contiene(const std::string& texto, const std::string& linea) {
+    revisar(texto.find(linea + "\n") != std::string::npos, "falta \"" + linea + "\"");
+}
+
+std::string pedir(const char* pedido) {
+    sockaddr_un dir{};
+    dir.sun_family = AF_UNIX;
+    strcpy(dir.sun_path, SOCKET_PRUEBA);
+    int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(s, reinterpret_cast<sockaddr*>(&dir), sizeof(dir)) < 0) {
+        close(s);
+        return "";
+    }
+    if (pedido) write(s, pedido, strlen(pedido));
+    else shutdown(s, SHUT_WR);
+    std::string texto;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(s, buffer, sizeof(buffer))) > 0) texto.append(buffer, size_t(n));
+    close(s);
+    return texto;
+}
+
+int main() {
+    contador.sumar();
+    contador.sumar(41);
+    medidor.fijar(1500);
+    histograma.observar(500000);
+    histograma.observar(2000000);
+    histograma.observar(9000000);
+    std::string texto = Metricas::global().texto();
+    contiene(texto, "# TYPE prueba_total counter");
+    contiene(texto, "prueba_total 42");
+    contiene(texto, "# TYPE prueba_medidor gauge");
+    contiene(texto, "prueba_medidor 1.5");
+    contiene(texto, "# TYPE prueba_segundos histogram");
+    contiene(texto, "prueba_segundos_bucket{le=\"0.001\"} 1");
+    contiene(texto, "prueba_segundos_bucket{le=\"0.005\"} 2");
+    contiene(texto, "prueba_segundos_bucket{le=\"+Inf\"} 3");
+    contiene(texto, "prueba_segundos_sum 0.0115");
+    contiene(texto, "prueba_segundos_count 3");
+    // Las del piano también están, en cero
+    contiene(texto, "piano_xruns_total 0");
+
+    std::vector<std::thread> hilos;
+    for (int h = 0; h < HILOS; ++h)
+        hilos.emplace_back([] {
+            for (int i = 0; i < OBSERVACIONES; ++i) compartido.observar(uint64_t(i % 200));
+        });
+    for (auto& h : hilos) h.join();
+    revisar(compartido.cantidad() == uint64_t(HILOS) * OBSERVACIONES,
+            "se observaron " + std::to_string(compartido.cantidad()) + " de " + std::to_string(HILOS * OBSERVACIONES));
+    texto = Metricas::global().texto();
+    // 0..10 son 11 de cada 200, 0..100 son 101
+    contiene(texto, "prueba_hilos_bucket{le=\"10\"} " + std::to_string(HILOS * OBSERVACIONES / 200 * 11));
+    contiene(texto, "prueba_hilos_bucket{le=\"100\"} " + std::to_string(HILOS * OBSERVACIONES / 200 * 101));
+
+    // Un archivo que no es socket no se borra
+    FILE* archivo = fopen(SOCKET_PRUEBA, "w");
+    if (archivo) fclose(archivo);
+    revisar(!Metricas::global().servir(SOCKET_PRUEBA), "se sirvió sobre un archivo común");
+    revisar(access(SOCKET_PRUEBA, F_OK) == 0, "se borró un archivo que no era socket");
+    remove(SOCKET_PRUEBA);
+
+    revisar(Metricas::global().servir(SOCKET_PRUEBA), "abrir " SOCKET_PRUEBA);
+    std::string solo = pedir(nullptr);
+    revisar(solo == Metricas::global().texto(), "sin pedido no llegó exactamente el texto");
+    std::string http = pedir("GET /metrics HTTP/1.0\r\n\r\n");
+    revisar(http.compare(0, 17, "HTTP/1.0 200 OK\r\n") == 0, "con GET no llegó la cabecera HTTP");
+    revisar(http.size() > solo.size() && http.compare(http.size() - solo.size(), solo.size(), solo) == 0, "con GET no llegó el texto");
+    Metricas::global().detener();
+    revisar(access(SOCKET_PRUEBA, F_OK) != 0, "el socket quedó después de detener()");
+
+    std::cout << (fallas ? "Hubo fallas\n" : "Métricas bien\n");
+    return fallas ? 1 : 0;
+}
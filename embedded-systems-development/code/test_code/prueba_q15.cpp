@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "../piano/sintetizador.h"
+#include "../piano/linea_tiempo.h"
+
+// Compara la síntesis Q15 con la flotante tocando lo mismo: un acorde que
+// entra nota por nota, una nota aguda encima y todo soltado, en modo vivo y
+// con la cache. La diferencia entre las dos salidas se toma como ruido y la
+// relación señal/ruido tiene que pasar SNR_MINIMO_DB. Al final aprieta las
+// 25 teclas: la mezcla satura, y la suma entera no puede dar la vuelta.
+//
+// En modo vivo buena parte de esa diferencia es de la flotante: su fase en
+// float (la fórmula de Faust) se corre un poco con cada muestra, y la Q32 no.
+// Con la cache, donde no hay fase que acumular, la distancia es mucho menor.
+
+#define PERIODO 256
+#define SNR_MINIMO_DB 55.0
+
+std::vector<int16_t> tocar(Aritmetica aritmetica, ModoSintesis modo, const LineaTiempo& linea, uint64_t total) {
+    Sintetizador sinte;
+    sinte.fijarModo(modo);
+    sinte.fijarAritmetica(aritmetica);
+    LineaTiempo copia = linea;
+    std::vector<int16_t> salida(total);
+    for (uint64_t reloj = 0; reloj < total; reloj += PERIODO)
+        copia.renderPeriodo(sinte, reloj, salida.data() + reloj, int(std::min<uint64_t>(PERIODO, total - reloj)));
+    return salida;
+}
+
+double snr(const std::vector<int16_t>& referencia, const std::vector<int16_t>& prueba) {
+    double senal = 0, ruido = 0;
+    for (size_t i = 0; i < referencia.size(); ++i) {
+        double d = double(referencia[i]) - prueba[i];
+        senal += double(referencia[i]) * referencia[i];
+        ruido += d * d;
+    }
+    return ruido > 0 ? 10.0 * std::log10(senal / ruido) : 200.0;
+}
+
+int main() {
+    const uint64_t ms = FRECUENCIA_MUESTREO / 1000;
+    LineaTiempo frase;
+    frase.agregar(0, indiceNota("C4"), true);
+    frase.agregar(150 * ms + 17, indiceNota("E4"), true);
+    frase.agregar(300 * ms + 101, indiceNota("G4"), true);
+    frase.agregar(600 * ms, indiceNota("C6"), true);
+    frase.agregar(900 * ms + 33, indiceNota("C6"), false);
+    frase.agregar(1200 * ms, indiceNota("C4"), false);
+    frase.agregar(1200 * ms, indiceNota("E4"), false);
+    frase.agregar(1200 * ms, indiceNota("G4"), false);
+    frase.ordenar();
+    uint64_t total = 1500 * ms;
+
+    bool ok = true;
+    const char* nombres[] = { "viva", "cache" };
+    for (int m = 0; m < 2; ++m) {
+        ModoSintesis modo = ModoSintesis(m);
+        double db = snr(tocar(ARITMETICA_FLOTANTE, modo, frase, total), tocar(ARITMETICA_Q15, modo, frase, total));
+        bool bien = db >= SNR_MINIMO_DB;
+        ok = ok && bien;
+        std::cout << "SNR " << nombres[m] << ": " << db << " dB (mínimo " << SNR_MINIMO_DB << ") "
+                  << (bien ? "ok" : "FALLA") << "\n";
+    }
+
+    // Todas las teclas: donde la flotante satura, la Q15 tiene que quedar
+    // del mismo lado y cerca del tope
+    LineaTiempo todas;
+    for (int n = 0; n < NUM_NOTAS; ++n) todas.agregar(0, n, true);
+    todas.ordenar();
+    std::vector<int16_t> flotante = tocar(ARITMETICA_FLOTANTE, SINTESIS_VIVA, todas, 500 * ms);
+    std::vector<int16_t> q15 = tocar(ARITMETICA_Q15, SINTESIS_VIVA, todas, 500 * ms);
+    long saturadas = 0, vueltas = 0;
+    for (size_t i = 0; i < flotante.size(); ++i) {
+        if (std::abs(int(flotante[i])) < 32767) continue;
+        ++saturadas;
+        if ((flotante[i] > 0) != (q15[i] > 0) || std::abs(int(q15[i])) < 16384) ++vueltas;
+    }
+    bool satura = vueltas == 0;
+    ok = ok && satura;
+    std::cout << "Con " << NUM_NOTAS << " teclas: " << saturadas << " muestras saturadas, "
+              << vueltas << " que dieron la vuelta " << (satura ? "ok" : "FALLA") << "\n";
+
+    std::cout << (ok ? "La síntesis Q15 coincide con la flotante\n" : "La síntesis Q15 se aparta de la flotante\n");
+    return ok ? 0 : 1;
+}
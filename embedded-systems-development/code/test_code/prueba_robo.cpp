@@ -0,0 +1,121 @@
+#include <iostream>
+#include <cmath>
+#include "../piano/sintetizador.h"
+
+// Prueba el reparto de voces. Cada política debe quitarle la voz a la nota
+// que corresponde, las notas ya soltadas se roban primero, el número de voces
+// nunca pasa del límite y el robo no hace clic: la nota robada baja a cero en
+// ROBO_MS mientras la nueva hace su ataque. Esa última parte usa solo dos
+// voces para que la mezcla (con la cola) no llegue a saturar. Una voz que
+// todavía apaga la cola de un robo no se vuelve a robar si hay otra.
+
+#define PERIODO 256
+#define VOCES 4
+#define VOCES_CLIC 2
+
+void tocarMs(Sintetizador& sinte, double ms, double* peorSalto = nullptr) {
+    static double a = 0, b = 0;
+    int16_t buffer[PERIODO];
+    long total = long(ms * FRECUENCIA_MUESTREO / 1000);
+    for (long hechas = 0; hechas < total; hechas += PERIODO) {
+        int frames = int(std::min<long>(PERIODO, total - hechas));
+        sinte.render(buffer, frames);
+        for (int i = 0; i < frames; ++i) {
+            double x = buffer[i];
+            if (peorSalto) *peorSalto = std::max(*peorSalto, std::fabs(x - 2 * b + a));
+            a = b;
+            b = x;
+        }
+    }
+}
+
+// Aprieta 1, 0 y 2, espera, aprieta 3 y enseguida 4: la más vieja es 1, la
+// más grave 0 y la más suave 3, que todavía está en el ataque
+int robada(PoliticaRobo politica) {
+    Sintetizador sinte;
+    sinte.fijarPolifonia(VOCES, politica);
+    sinte.notaOn(1);
+    sinte.notaOn(0);
+    sinte.notaOn(2);
+    tocarMs(sinte, 50);
+    sinte.notaOn(3);
+    tocarMs(sinte, 1);
+    sinte.notaOn(4);
+    for (int n = 0; n < 4; ++n)
+        if (!sinte.sonando(n)) return n;
+    return -1;
+}
+
+int main() {
+    bool ok = true;
+    const int esperada[] = { 1, 3, 0 };
+    for (int p = 0; p < 3; ++p) {
+        int r = robada(PoliticaRobo(p));
+        bool bien = r == esperada[p];
+        ok = ok && bien;
+        std::cout << "Robar " << nombresPolitica[p] << ": se robó " << (r >= 0 ? nombresNotas[r] : "ninguna")
+                  << " (esperada " << nombresNotas[esperada[p]] << ") " << (bien ? "ok" : "FALLA") << "\n";
+    }
+
+    // La nota soltada se roba antes que la más vieja
+    {
+        Sintetizador sinte;
+        sinte.fijarPolifonia(VOCES, ROBAR_VIEJA);
+        for (int n = 0; n < VOCES; ++n) sinte.notaOn(n);
+        tocarMs(sinte, 20);
+        sinte.notaOff(2);
+        tocarMs(sinte, 20);
+        sinte.notaOn(4);
+        bool bien = !sinte.sonando(2) && sinte.sonando(0);
+        ok = ok && bien;
+        std::cout << "Primero las soltadas: " << (bien ? "ok" : "FALLA") << "\n";
+    }
+
+    // Con dos voces, la grave toma la voz de 5 y queda con su cola; la
+    // siguiente, antes de ROBO_MS, le roba a 10 aunque 0 sea más grave
+    {
+        Sintetizador sinte;
+        sinte.fijarPolifonia(2, ROBAR_GRAVE);
+        sinte.notaOn(5);
+        sinte.notaOn(10);
+        tocarMs(sinte, 50);
+        sinte.notaOn(0);
+        tocarMs(sinte, 1);
+        sinte.notaOn(12);
+        bool bien = sinte.sonando(0) && sinte.sonando(12) && !sinte.sonando(10);
+        ok = ok && bien;
+        std::cout << "La cola de un robo no se corta: " << (bien ? "ok" : "FALLA") << "\n";
+    }
+
+    // Todas las teclas, una cada 10 ms, en la nota más aguda para el peor salto
+    {
+        Sintetizador sinte;
+        sinte.fijarPolifonia(VOCES_CLIC, ROBAR_VIEJA);
+        double peor = 0;
+        int maxVoces = 0;
+        tocarMs(sinte, 10);   // silencio, para no medir contra la prueba anterior
+        for (int n = 0; n < NUM_NOTAS; ++n) {
+            sinte.notaOn(n);
+            tocarMs(sinte, 10, &peor);
+            maxVoces = std::max(maxVoces, sinte.vocesActivas());
+        }
+        bool limite = maxVoces <= VOCES_CLIC && sinte.robos() == uint64_t(NUM_NOTAS - VOCES_CLIC);
+        ok = ok && limite;
+        std::cout << "Voces como máximo " << maxVoces << ", robos " << sinte.robos() << " "
+                  << (limite ? "ok" : "FALLA") << "\n";
+
+        // Todas las voces en su nivel más alto, más lo que agregan el ataque
+        // de la nueva y la rampa de la robada, como en prueba_envolvente
+        double amplitud = GANANCIA_VOZ * 32767.0;
+        double w = 2.0 * M_PI * frecuencias[NUM_NOTAS - 1] / FRECUENCIA_MUESTREO;
+        double rampas = 1000.0 / (ATAQUE_MS * FRECUENCIA_MUESTREO) + 1000.0 / (ROBO_MS * FRECUENCIA_MUESTREO);
+        double limiteSalto = amplitud * (VOCES_CLIC * w * w + rampas * (1 + 2 * w)) + 3.0;
+        bool suave = peor <= limiteSalto;
+        ok = ok && suave;
+        std::cout << "Mayor segunda diferencia " << peor << " (límite " << limiteSalto << ") "
+                  << (suave ? "ok" : "FALLA") << "\n";
+    }
+
+    std::cout << (ok ? "Reparto de voces correcto\n" : "El reparto de voces falla\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include <gpiod.h>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../piano/matriz.h"
+#include "../piano/motor_audio.h"
+#include "../piano/captura.h"
+#include "../tutor/canciones.h"
+
+#ifndef VIGILAR_RT
+#error "Compilar con -DVIGILAR_RT"
+#endif
+#ifndef GPIO_SIMULADO
+#error "Compilar con -I../simulador para usar el GPIO simulado"
+#endif
+
+// El render de audio no pide memoria, no toma locks ni hace llamadas que
+// bloquean, con el vigilante de piano/vigilante_rt.h:
+//  - el vigilante detecta new, delete, un mutex y un usleep dentro de una
+//    zona, también en el hilo de audio, y nada fuera de ella
+//  - cada canción en los cuatro modos de síntesis, como renderizar
+//  - una captura de escaneos generada al azar, renderizada como
+//    renderizar --captura y reproducida en tiempo real con el GPIO simulado,
+//    escaneada como main_menu y tocada por el MotorAudio de siempre
+//
+// Uso: g++ -DVIGILAR_RT -rdynamic -I../simulador prueba_rt.cpp -o prueba_rt -lasound -lpthread
+//      ./prueba_rt [--dispositivo X]   (por defecto "null")
+
+#define PERIODO 256
+#define TICK_US 5000
+#define ESCANEOS 300
+#define ARCHIVO "prueba_rt.teclas"
+
+int fallas = 0;
+int* volatile guardado;                 // que el compilador no se salte el new
+std::atomic<uint64_t> framesVistos{0};
+std::atomic<bool> ensuciar{false};
+
+void revisar(bool ok, const std::string& que) {
+    if (ok) return;
+    std::cout << "FALLA " << que << "\n";
+    ++fallas;
+}
+
+// En el hilo de audio, dentro de la zona; con "ensuciar" pide memoria
+void observar(const int16_t*, int frames, void*) {
+    framesVistos.fetch_add(uint64_t(frames), std::memory_order_relaxed);
+    if (ensuciar.load(std::memory_order_relaxed)) delete (guardado = new int(3));
+}
+
+// Violaciones que agregó "paso"
+template <typename F>
+uint64_t contar(F&& paso) {
+    uint64_t antes = violacionesTiempoReal();
+    paso();
+    return violacionesTiempoReal() - antes;
+}
+
+void renderizarEntera(Sintetizador& sinte, LineaTiempo& linea) {
+    int16_t buffer[PERIODO];
+    uint64_t reloj = 0;
+    while (!linea.terminada() || sinte.vocesActivas() > 0) {
+        ZonaTiempoReal zona;
+        linea.renderPeriodo(sinte, reloj, buffer, PERIODO);
+        reloj += PERIODO;
+    }
+}
+
+int main(int argc, char** argv) {
+    // El vigilante funciona: cada una de estas es una violación
+    std::cout << "Las primeras violaciones y las del final son a propósito\n";
+    std::mutex m;
+    uint64_t n = contar([&] {
+        ZonaTiempoReal zona;
+        guardado = new int(1);
+        delete guardado;
+        m.lock();
+        m.unlock();
+        usleep(1);
+    });
+    revisar(n == 4, "el vigilante vio " + std::to_string(n) + " de 4 violaciones");
+    n = contar([&] {
+        guardado = new int(2);
+        delete guardado;
+    });
+    revisar(n == 0, "fuera de una zona se contaron " + std::to_string(n) + " violaciones");
+
+    // Canciones en todos los modos; el cache se arma fuera de la zona
+    for (int modo = 0; modo < 2; ++modo)
+        for (int aritmetica = 0; aritmetica < 2; ++aritmetica)
+            for (const Cancion* c : canciones) {
+                Sintetizador sinte;
+                sinte.fijarModo(ModoSintesis(modo));
+                sinte.fijarAritmetica(Aritmetica(aritmetica));
+                LineaTiempo linea = lineaDeCancion(*c, c->bpm);
+                n = contar([&] { renderizarEntera(sinte, linea); });
+                revisar(n == 0, c->nombre + " modo " + std::to_string(modo) + " aritmética " + std::to_string(aritmetica) + ": " +
+                                    std::to_string(n) + " violaciones");
+            }
+
+    // Una captura al azar: acordes que cambian cada pocos escaneos
+    std::vector<MuestraEscaneo> muestras;
+    unsigned semilla = 5;
+    uint32_t teclas = 0;
+    for (int i = 0; i < ESCANEOS; ++i) {
+        if (rand_r(&semilla) % 6 == 0) teclas = uint32_t(rand_r(&semilla)) & uint32_t(rand_r(&semilla)) & ((1u << NUM_NOTAS) - 1);
+        muestras.push_back({1000000000ull + uint64_t(i) * TICK_US * 1000, teclas});
+    }
+    CapturaTeclado captura;
+    revisar(captura.abrir(ARCHIVO), "abrir " ARCHIVO);
+    for (const auto& e : muestras) captura.registrar(e.ns, e.teclas);
+    captura.cerrar();
+
+    Sintetizador sinte;
+    LineaTiempo linea;
+    revisar(lineaDeCaptura(ARCHIVO, linea) > 0, "la captura no tiene notas");
+    n = contar([&] { renderizarEntera(sinte, linea); });
+    revisar(n == 0, "captura renderizada: " + std::to_string(n) + " violaciones");
+
+    // La misma captura en tiempo real por la matriz simulada y el MotorAudio
+    ConfigAlsa alsa;
+    alsa.dispositivo = "null";
+    leerConfigAlsa(argc, argv, alsa);
+    Matriz matriz;
+    revisar(matriz.abrir("prueba_rt"), "abrir la matriz");
+    MotorAudio audio;
+    if (!audio.abrir(alsa)) return 1;
+    audio.observar(observar, nullptr);
+    std::vector<MuestraEscaneo> leidas;
+    revisar(leerCaptura(ARCHIVO, leidas), "leer " ARCHIVO);
+    PlacaSimulada& placa = PlacaSimulada::global();
+    uint64_t inicio = placa.ahoraUs() + 10000;
+    placa.reproducirCaptura(leidas, inicio);
+    uint64_t fin = inicio + (leidas.back().ns - leidas.front().ns) / 1000 + 200000;
+    uint64_t antes = violacionesTiempoReal();
+    uint32_t teclasAntes = 0;
+    int eventos = 0;
+    while (placa.ahoraUs() < fin) {
+        uint64_t ns = ahoraNs();
+        uint32_t t = matriz.escanear();
+        uint32_t cambios = t ^ teclasAntes;
+        for (int i = 0; i < NUM_NOTAS; ++i) {
+            if (!(cambios & (1u << i))) continue;
+            if (t & (1u << i)) audio.notaOn(i, ns);
+            else audio.notaOff(i, ns);
+            ++eventos;
+        }
+        teclasAntes = t;
+        usleep(TICK_US);
+    }
+    n = violacionesTiempoReal() - antes;
+    revisar(eventos > 0, "la reproducción no tocó nada");
+    revisar(framesVistos > 0, "el hilo de audio no renderizó nada");
+    revisar(n == 0, "reproducción en tiempo real: " + std::to_string(n) + " violaciones");
+
+    // Y el hilo de audio está vigilado: un observador que pide memoria se ve
+    ensuciar = true;
+    usleep(100000);
+    revisar(violacionesTiempoReal() > antes + n, "el vigilante no vio el new en el hilo de audio");
+    audio.cerrar();
+    matriz.cerrar();
+    remove(ARCHIVO);
+
+    std::cout << "Reproducción: " << eventos << " eventos, " << framesVistos << " muestras\n";
+    std::cout << (fallas ? "Hubo fallas\n" : "Audio sin violaciones de tiempo real\n");
+    return fallas ? 1 : 0;
+}
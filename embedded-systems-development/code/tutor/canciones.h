@@ -0,0 +1,144 @@
+#ifndef CANCIONES_H
+#define CANCIONES_H
+
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include "../piano/linea_tiempo.h"
+
+struct NotaTemporizada {
+    std::string nota;
+    uint32_t inicioMs;
+    uint32_t duracionMs;
+};
+
+// Canciones del tutor. Las incluidas aquí van a una nota por pulso; las que
+// se cargan de un archivo .cancion traen el tiempo de cada nota.
+struct Cancion {
+    std::string nombre;
+    int bpm;
+    std::vector<std::string> notas;
+    std::vector<NotaTemporizada> tiempos = {};
+};
+
+const Cancion estrellita = {"estrellita", 100, {
+    "C4", "C4", "G4", "G4", "A4", "A4", "G4",
+    "F4", "F4", "E4", "E4", "D4", "D4", "C4",
+    "G4", "G4", "F4", "F4", "E4", "E4", "D4",
+    "G4", "G4", "F4", "F4", "E4", "E4", "D4",
+    "C4", "C4", "G4", "G4", "A4", "A4", "G4",
+    "F4", "F4", "E4", "E4", "D4", "D4", "C4"
+}};
+
+const Cancion hbd = {"hbd", 110, {
+    "C4", "C4", "D4", "C4", "F4", "E4",
+    "C4", "C4", "D4", "C4", "G4", "F4",
+    "C4", "C4", "C5", "A4", "F4", "E4", "D4",
+    "A#4", "A#4", "A4", "F4", "G4", "F4"
+}};
+
+const Cancion piratas = {"piratas", 140, {
+    "E4", "G4", "A4", "A4",
+    "A4", "B4", "C5", "C5",
+    "C5", "D5", "B4", "B4",
+    "A4", "G4", "G4", "A4", // primera parte
+    "E4", "G4", "A4", "A4",
+    "A4", "B4", "C5", "C5",
+    "C5", "D5", "B4", "B4",
+    "A4", "G4", "A4",       // segunda parte
+    "E4", "G4", "A4", "A4",
+    "A4", "C5", "D5", "D5",
+    "D5", "E5", "F5", "F5", "E5", "D5", "E5",
+    "A4", "B4", "C5", "C5", "D5", "E5", "A4",   // tercer parte
+    "A4", "C5", "B4", "B4", "C5", "A4", "B4"
+}};
+
+const Cancion pollitos = {"pollitos", 120, {
+    "C5", "D5", "E5", "F5", "G5", "G5",
+    "A5", "C6", "A5", "C6", "G5", "G5",
+    "F5", "F5", "F5", "F5", "E5", "E5",
+    "D5", "D5", "D5", "D5", "C5", "C5"
+}};
+
+const Cancion* const canciones[] = { &estrellita, &hbd, &piratas, &pollitos };
+
+// Tiempos de cada nota; si la canción no los trae se reparten a un pulso por nota
+inline std::vector<NotaTemporizada> tiemposDe(const Cancion& c) {
+    if (!c.tiempos.empty()) return c.tiempos;
+    std::vector<NotaTemporizada> t;
+    uint32_t pulso = 60000 / uint32_t(c.bpm > 0 ? c.bpm : 100);
+    for (size_t i = 0; i < c.notas.size(); ++i)
+        t.push_back({c.notas[i], uint32_t(i) * pulso, pulso * 85 / 100});
+    return t;
+}
+
+// Formato .cancion: líneas "nombre X", "bpm N" y "NOTA inicio_ms duracion_ms",
+// con las notas en orden de inicio. Las líneas con # son comentarios. Un bpm
+// que no es un número positivo invalida el archivo.
+inline bool cargarCancion(const std::string& ruta, Cancion& c) {
+    std::ifstream archivo(ruta);
+    if (!archivo) return false;
+
+    c = Cancion{ruta, 100, {}};
+    std::string linea;
+    while (std::getline(archivo, linea)) {
+        if (linea.empty() || linea[0] == '#') continue;
+        std::istringstream ss(linea);
+        std::string campo;
+        ss >> campo;
+        if (campo == "nombre") ss >> c.nombre;
+        else if (campo == "bpm") {
+            if (!(ss >> c.bpm) || c.bpm <= 0) return false;
+        } else {
+            NotaTemporizada n{campo, 0, 0};
+            if (!(ss >> n.inicioMs >> n.duracionMs)) return false;
+            c.notas.push_back(n.nota);
+            c.tiempos.push_back(n);
+        }
+    }
+    return !c.notas.empty();
+}
+
+inline bool guardarCancion(const std::string& ruta, const Cancion& c) {
+    std::ofstream archivo(ruta);
+    if (!archivo) return false;
+    archivo << "nombre " << c.nombre << "\n";
+    archivo << "bpm " << c.bpm << "\n";
+    for (const auto& n : tiemposDe(c))
+        archivo << n.nota << " " << n.inicioMs << " " << n.duracionMs << "\n";
+    return bool(archivo);
+}
+
+// Eventos de la canción en muestras, con medio segundo de silencio antes de
+// empezar; bpm distinto al de la canción la acelera o la frena (sin bpm
+// válido se usa el de la canción, como en tiemposDe). Cada nota
+// dura al menos una muestra: con el apagado en la misma muestra que el
+// encendido, ordenar() lo pondría antes y la nota quedaría sonando.
+inline LineaTiempo lineaDeCancion(const Cancion& cancion, int bpm) {
+    LineaTiempo linea;
+    uint64_t silencio = FRECUENCIA_MUESTREO / 2;
+    int original = cancion.bpm > 0 ? cancion.bpm : 100;
+    double escala = double(original) / (bpm > 0 ? bpm : original);
+
+    for (const auto& n : tiemposDe(cancion)) {
+        int nota = indiceNota(n.nota);
+        if (nota < 0) continue;
+        uint64_t inicio = silencio + uint64_t(n.inicioMs * escala * FRECUENCIA_MUESTREO / 1000);
+        uint64_t largo = std::max<uint64_t>(1, uint64_t(n.duracionMs * escala * FRECUENCIA_MUESTREO / 1000));
+        linea.agregar(inicio, nota, true);
+        linea.agregar(inicio + largo, nota, false);
+    }
+    linea.ordenar();
+    return linea;
+}
+
+inline const Cancion* buscarCancion(const std::string& nombre) {
+    for (const Cancion* c : canciones)
+        if (nombre == c->nombre) return c;
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include <unistd.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include "canciones.h"
+#include "../piano/sintetizador.h"
+#include "../piano/linea_tiempo.h"
+#include "../piano/salida_alsa.h"
+#include "../piano/matriz.h"
+#include "../oled/visualizacion.h"
+
+#define CONSUMER "tutor-demo"
+#define PERIODO 256
+#define NUM_PERIODOS 4
+
+Pantalla pantalla;
+Visualizacion visual;
+
+// Modo escuchar: la canción suena sola y el LED de cada nota se enciende
+// cuando esa muestra sale por el parlante, usando el mismo reloj de audio.
+
+// Recorre los mismos eventos que el audio y los muestra en los LEDs cuando
+// el reloj de muestras audibles los alcanza. La matriz enciende un LED por
+// vez: el de la última nota; al soltarla pasa a otra que siga sonando.
+void seguirConLeds(Matriz& matriz, const LineaTiempo& linea, const SalidaAlsa& salida, std::atomic<bool>& terminar) {
+    uint32_t sonando = 0;
+    int encendida = -1;
+    for (const auto& e : linea.lista()) {
+        while (salida.muestrasAudibles() < e.muestra) {
+            if (terminar) return;
+            usleep(1000);
+        }
+        sonando = e.encender ? (sonando | (1u << e.nota)) : (sonando & ~(1u << e.nota));
+        if (e.encender || e.nota == encendida) {
+            encendida = e.encender ? e.nota : (sonando ? __builtin_ctz(sonando) : -1);
+            if (encendida >= 0) matriz.encenderLed(encendida);
+            else matriz.apagarLeds();
+        }
+        visual.publicarTeclas(sonando);
+    }
+}
+
+int main(int argc, char** argv) {
+    // Acepta el nombre de una canción incluida o la ruta de un archivo .cancion
+    std::string pedida = argc > 1 ? argv[1] : "estrellita";
+    Cancion cargada;
+    const Cancion* cancion = buscarCancion(pedida);
+    if (!cancion && cargarCancion(pedida, cargada)) cancion = &cargada;
+    if (!cancion) {
+        std::cerr << "Canción desconocida, opciones: estrellita, hbd, piratas, pollitos o un archivo .cancion\n";
+        return 1;
+    }
+    // Sin bpm se usa el de la canción
+    int bpm = cancion->bpm;
+    if (argc > 2) {
+        char* fin;
+        long pedido = strtol(argv[2], &fin, 10);
+        if (fin == argv[2] || *fin || pedido <= 0 || pedido > 1000) {
+            std::cerr << "bpm inválido: " << argv[2] << "\nUso: " << argv[0] << " [canción] [bpm de 1 a 1000]\n";
+            return 1;
+        }
+        bpm = int(pedido);
+    }
+
+    Matriz matriz;
+    if (!matriz.abrir(CONSUMER)) {
+        std::cerr << "Error al inicializar GPIO\n";
+        return 1;
+    }
+
+    SalidaAlsa salida;
+    if (!salida.abrir("default", FRECUENCIA_MUESTREO, PERIODO, NUM_PERIODOS)) {
+        std::cerr << "Error al inicializar audio\n";
+        return 1;
+    }
+
+    Sintetizador sinte;
+    LineaTiempo linea = lineaDeCancion(*cancion, bpm);
+    std::atomic<bool> terminar{false};
+
+    // La pantalla es opcional: sin ella solo se pierde la visualización
+    bool hayPantalla = pantalla.abrir();
+    if (hayPantalla) visual.iniciar(pantalla);
+    std::thread leds(seguirConLeds, std::ref(matriz), std::cref(linea), std::cref(salida), std::ref(terminar));
+
+    std::cout << "Reproduciendo: " << cancion->nombre << " a " << bpm << " bpm\n";
+
+    int frames = std::min(int(salida.tamPeriodo()), MAX_PERIODO);
+    int16_t buffer[MAX_PERIODO];
+    uint64_t reloj = 0;
+    uint64_t fin = linea.duracion() + FRECUENCIA_MUESTREO / 2;
+
+    while (reloj < fin) {
+        linea.renderPeriodo(sinte, reloj, buffer, frames);
+        visual.publicarNivel(nivelPico(buffer, frames));
+        if (!salida.escribir(buffer, frames)) break;
+        reloj += frames;
+    }
+
+    salida.drenar();
+    terminar = true;
+    leds.join();
+    if (hayPantalla) {
+        visual.detener();
+        visual.imprimirEstadisticas();
+        pantalla.cerrar();
+    }
+
+    matriz.apagarLeds();
+    salida.cerrar();
+    matriz.cerrar();
+    return 0;
+}
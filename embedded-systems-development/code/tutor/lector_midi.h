@@ -0,0 +1,262 @@
+#ifndef LECTOR_MIDI_H
+#define LECTOR_MIDI_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+// Evento de nota ya convertido a microsegundos desde el inicio del archivo
+struct EventoMidi {
+    uint64_t micros;
+    int nota;        // número MIDI, 60 = C4
+    bool encender;
+};
+
+// Lleva cualquier nota MIDI al rango del piano (C4-C6) moviéndola por octavas.
+// Devuelve el índice 0..24 que usa el sintetizador.
+inline int plegarNota(int midi) {
+    while (midi < 60) midi += 12;
+    while (midi > 84) midi -= 12;
+    return midi - 60;
+}
+
+// Lee un Standard MIDI File (tipo 0 o 1) directamente del archivo mapeado en
+// memoria. Los eventos se decodifican de a uno cuando se piden, mezclando las
+// pistas por tick, así que la memoria usada solo depende del número de pistas.
+class LectorMidi {
+public:
+    ~LectorMidi() { cerrar(); }
+
+    bool abrir(const std::string& ruta) {
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) {
+            perror("No se pudo abrir el archivo MIDI");
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size < 14) {
+            close(fd);
+            std::cerr << "Archivo MIDI vacío o inválido\n";
+            return false;
+        }
+        tamano = size_t(st.st_size);
+        void* m = mmap(nullptr, tamano, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (m == MAP_FAILED) {
+            perror("mmap");
+            return false;
+        }
+        datos = static_cast<const uint8_t*>(m);
+        madvise(m, tamano, MADV_SEQUENTIAL);
+
+        if (!leerCabecera()) {
+            cerrar();
+            return false;
+        }
+        return true;
+    }
+
+    void cerrar() {
+        if (datos) munmap(const_cast<uint8_t*>(datos), tamano);
+        datos = nullptr;
+        pistas.clear();
+    }
+
+    // Entrega el siguiente evento de nota en orden de tiempo; false al terminar
+    bool siguiente(EventoMidi& e) {
+        while (true) {
+            Pista* p = pistaMasTemprana();
+            if (!p) return false;
+
+            avanzarReloj(p->tick);
+            if (decodificar(*p, e)) return true;
+        }
+    }
+
+    // Tiempo del último evento leído; cuando siguiente() da false, el fin del archivo
+    uint64_t micros() const { return microsActual; }
+
+    int formato() const { return formatoArchivo; }
+    size_t numPistas() const { return pistas.size(); }
+
+private:
+    struct Pista {
+        const uint8_t* p;
+        const uint8_t* fin;
+        uint64_t tick;
+        uint8_t estado;      // running status
+        bool terminada;
+    };
+
+    const uint8_t* datos = nullptr;
+    size_t tamano = 0;
+    int formatoArchivo = 0;
+    uint32_t division = 480;
+    std::vector<Pista> pistas;
+
+    // Mapa de tempo aplicado sobre la marcha
+    uint64_t tickBase = 0;
+    uint64_t microsBase = 0;
+    uint32_t tempo = 500000;  // microsegundos por negra
+    uint64_t microsActual = 0;
+
+    static uint32_t leer32(const uint8_t* p) { return (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+    static uint16_t leer16(const uint8_t* p) { return uint16_t((p[0] << 8) | p[1]); }
+
+    static uint32_t leerVariable(const uint8_t*& p, const uint8_t* fin) {
+        uint32_t valor = 0;
+        for (int i = 0; i < 4 && p < fin; ++i) {
+            uint8_t b = *p++;
+            valor = (valor << 7) | (b & 0x7F);
+            if (!(b & 0x80)) break;
+        }
+        return valor;
+    }
+
+    // Salta l bytes de la pista sin pasar de su fin
+    static void saltar(Pista& t, uint32_t l) {
+        t.p += l < size_t(t.fin - t.p) ? l : size_t(t.fin - t.p);
+    }
+
+    bool leerCabecera() {
+        if (std::string(reinterpret_cast<const char*>(datos), 4) != "MThd") {
+            std::cerr << "No es un archivo MIDI\n";
+            return false;
+        }
+        uint32_t largo = leer32(datos + 4);
+        if (largo < 6 || largo > tamano - 8) {
+            std::cerr << "Cabecera MIDI inválida\n";
+            return false;
+        }
+        formatoArchivo = leer16(datos + 8);
+        uint16_t n = leer16(datos + 10);
+        division = leer16(datos + 12);
+
+        if (formatoArchivo > 1) {
+            std::cerr << "Solo se soportan archivos MIDI tipo 0 y 1\n";
+            return false;
+        }
+        if (division & 0x8000) {
+            std::cerr << "División SMPTE no soportada\n";
+            return false;
+        }
+
+        // Solo se ubican los bloques MTrk; los eventos se leen después
+        const uint8_t* p = datos + 8 + largo;
+        const uint8_t* finArchivo = datos + tamano;
+        while (finArchivo - p >= 8 && pistas.size() < n) {
+            uint32_t l = leer32(p + 4);
+            const uint8_t* inicio = p + 8;
+            const uint8_t* fin = l <= size_t(finArchivo - inicio) ? inicio + l : finArchivo;
+            if (std::string(reinterpret_cast<const char*>(p), 4) == "MTrk") {
+                Pista pista{inicio, fin, 0, 0, inicio >= fin};
+                if (!pista.terminada) pista.tick = leerVariable(pista.p, pista.fin);
+                pistas.push_back(pista);
+            }
+            p = fin;
+        }
+        return !pistas.empty();
+    }
+
+    Pista* pistaMasTemprana() {
+        Pista* mejor = nullptr;
+        for (auto& p : pistas)
+            if (!p.terminada && (!mejor || p.tick < mejor->tick)) mejor = &p;
+        return mejor;
+    }
+
+    void avanzarReloj(uint64_t tick) {
+        microsActual = microsBase + (tick - tickBase) * tempo / division;
+    }
+
+    // Decodifica un evento de la pista; devuelve true si fue una nota
+    bool decodificar(Pista& t, EventoMidi& e) {
+        bool esNota = false;
+        // Un delta justo al final de la pista deja p en fin
+        if (t.p >= t.fin) {
+            t.terminada = true;
+            return false;
+        }
+        uint8_t b = *t.p;
+
+        if (b & 0x80) {
+            ++t.p;
+            if (b < 0xF0) t.estado = b;
+            else if (b == 0xF0 || b == 0xF7 || b == 0xFF) t.estado = 0;   // sysex y meta cancelan el running status
+        } else {
+            b = t.estado;  // running status: el byte ya es el primer dato
+        }
+
+        if (b == 0xFF) {
+            uint8_t tipo = t.p < t.fin ? *t.p++ : 0;
+            uint32_t l = leerVariable(t.p, t.fin);
+            if (tipo == 0x51 && l == 3 && t.fin - t.p >= 3) {
+                tickBase = t.tick;
+                microsBase = microsActual;
+                tempo = (uint32_t(t.p[0]) << 16) | (t.p[1] << 8) | t.p[2];
+            } else if (tipo == 0x2F) {
+                t.terminada = true;
+            }
+            saltar(t, l);
+        } else if (b == 0xF0 || b == 0xF7) {
+            saltar(t, leerVariable(t.p, t.fin));
+        } else if (b >= 0x80 && b < 0xF0) {
+            uint8_t tipo = b & 0xF0;
+            uint8_t canal = b & 0x0F;
+            int nDatos = (tipo == 0xC0 || tipo == 0xD0) ? 1 : 2;
+            if (t.fin - t.p < nDatos) {
+                t.terminada = true;
+                return false;
+            }
+            uint8_t d1 = t.p[0];
+            uint8_t d2 = nDatos > 1 ? t.p[1] : 0;
+            t.p += nDatos;
+
+            // El canal 10 es percusión y no tiene altura
+            if (canal != 9 && (tipo == 0x90 || tipo == 0x80)) {
+                e.micros = microsActual;
+                e.nota = d1;
+                e.encender = (tipo == 0x90 && d2 > 0);
+                esNota = true;
+            }
+        } else if (b < 0x80) {
+            // Dato sin estado previo: el archivo está corrupto
+            t.terminada = true;
+        }
+
+        if (t.p >= t.fin) t.terminada = true;
+        if (!t.terminada) t.tick += leerVariable(t.p, t.fin);
+        return esNota;
+    }
+};
+
+// Eventos ya plegados al piano. Como varias notas MIDI caen en la misma tecla,
+// cuenta cuántas la sostienen y solo avisa cuando la tecla cambia de estado.
+class PlegadorMidi {
+public:
+    explicit PlegadorMidi(LectorMidi& l) : lector(l) {}
+
+    bool siguiente(EventoMidi& e) {
+        while (lector.siguiente(e)) {
+            int tecla = plegarNota(e.nota);
+            e.nota = tecla;
+            if (e.encender) {
+                if (sostenidas[tecla]++ == 0) return true;
+            } else if (sostenidas[tecla] > 0) {
+                if (--sostenidas[tecla] == 0) return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    LectorMidi& lector;
+    int sostenidas[25] = {};
+};
+
+#endif
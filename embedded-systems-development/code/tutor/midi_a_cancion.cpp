@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "lector_midi.h"
+#include "canciones.h"
+#include "../piano/sintetizador.h"
+
+// Convierte un .mid (tipo 0 o 1) al formato .cancion del piano, plegando
+// todas las pistas al rango de 25 teclas C4-C6.
+// Uso: ./midi_a_cancion entrada.mid salida.cancion [nombre]
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " entrada.mid salida.cancion [nombre]\n";
+        return 1;
+    }
+
+    LectorMidi lector;
+    if (!lector.abrir(argv[1])) return 1;
+
+    Cancion cancion{argc > 3 ? argv[3] : "midi", 120, {}};
+    uint32_t inicio[NUM_NOTAS] = {};
+    bool sostenida[NUM_NOTAS] = {};
+    PlegadorMidi plegador(lector);
+    EventoMidi e;
+
+    // Una nota dura al menos 1 ms: con 0 el apagado caería en la misma
+    // muestra que el encendido y la nota quedaría sonando
+    auto cerrar = [&](int nota, uint32_t ms) {
+        cancion.tiempos.push_back({nombresNotas[nota], inicio[nota], std::max<uint32_t>(1, ms - inicio[nota])});
+        sostenida[nota] = false;
+    };
+
+    while (plegador.siguiente(e)) {
+        uint32_t ms = uint32_t(e.micros / 1000);
+        if (e.encender) {
+            inicio[e.nota] = ms;
+            sostenida[e.nota] = true;
+        } else {
+            cerrar(e.nota, ms);
+        }
+    }
+    // Las que no tienen note off terminan con el archivo
+    for (int n = 0; n < NUM_NOTAS; ++n)
+        if (sostenida[n]) cerrar(n, uint32_t(lector.micros() / 1000));
+
+    std::stable_sort(cancion.tiempos.begin(), cancion.tiempos.end(),
+                     [](const NotaTemporizada& a, const NotaTemporizada& b) { return a.inicioMs < b.inicioMs; });
+    for (const auto& n : cancion.tiempos) cancion.notas.push_back(n.nota);
+
+    if (cancion.notas.empty()) {
+        std::cerr << "El archivo no tiene notas\n";
+        return 1;
+    }
+    if (!guardarCancion(argv[2], cancion)) {
+        std::cerr << "No se pudo escribir " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::cout << "MIDI tipo " << lector.formato() << ", " << lector.numPistas() << " pistas, "
+              << cancion.notas.size() << " notas guardadas en " << argv[2] << "\n";
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <unistd.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include "lector_midi.h"
+#include "../piano/sintetizador.h"
+#include "../piano/linea_tiempo.h"
+#include "../piano/salida_alsa.h"
+#include "../piano/matriz.h"
+#include "../oled/visualizacion.h"
+
+#define CONSUMER "tutor-midi"
+#define PERIODO 256
+#define NUM_PERIODOS 4
+
+Pantalla pantalla;
+Visualizacion visual;
+
+// Reproduce un .mid directamente del archivo: los eventos se decodifican a
+// medida que el audio los necesita, así que la CPU y la memoria no dependen
+// del largo del archivo. Los LEDs siguen el mismo reloj de audio que en demo.
+
+// Entrega los eventos del archivo ya convertidos a muestras, de a uno
+class FuenteMidi {
+public:
+    explicit FuenteMidi(LectorMidi& l) : plegador(l) {}
+
+    const EventoNota* proximo() {
+        if (!hay && !terminada) {
+            EventoMidi e;
+            if (plegador.siguiente(e)) {
+                actual = {e.micros * FRECUENCIA_MUESTREO / 1000000, e.nota, e.encender};
+                hay = true;
+            } else {
+                terminada = true;
+            }
+        }
+        return hay ? &actual : nullptr;
+    }
+
+    void avanzar() { hay = false; }
+    bool fin() { return proximo() == nullptr; }
+
+private:
+    PlegadorMidi plegador;
+    EventoNota actual{};
+    bool hay = false;
+    bool terminada = false;
+};
+
+// Usa un segundo lector sobre el mismo archivo para no compartir estado con el
+// audio. Como en demo, el LED es el de la última nota y al soltarla pasa a
+// otra que siga sonando.
+void seguirConLeds(Matriz& matriz, const std::string& ruta, const SalidaAlsa& salida, std::atomic<bool>& terminar) {
+    LectorMidi lector;
+    if (!lector.abrir(ruta)) return;
+    FuenteMidi fuente(lector);
+
+    const EventoNota* e;
+    uint32_t sonando = 0;
+    int encendida = -1;
+    while ((e = fuente.proximo())) {
+        while (salida.muestrasAudibles() < e->muestra) {
+            if (terminar) return;
+            usleep(1000);
+        }
+        sonando = e->encender ? (sonando | (1u << e->nota)) : (sonando & ~(1u << e->nota));
+        if (e->encender || e->nota == encendida) {
+            encendida = e->encender ? e->nota : (sonando ? __builtin_ctz(sonando) : -1);
+            if (encendida >= 0) matriz.encenderLed(encendida);
+            else matriz.apagarLeds();
+        }
+        visual.publicarTeclas(sonando);
+        fuente.avanzar();
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " archivo.mid\n";
+        return 1;
+    }
+    std::string ruta = argv[1];
+
+    LectorMidi lector;
+    if (!lector.abrir(ruta)) return 1;
+
+    Matriz matriz;
+    if (!matriz.abrir(CONSUMER)) {
+        std::cerr << "Error al inicializar GPIO\n";
+        return 1;
+    }
+
+    SalidaAlsa salida;
+    if (!salida.abrir("default", FRECUENCIA_MUESTREO, PERIODO, NUM_PERIODOS)) {
+        std::cerr << "Error al inicializar audio\n";
+        return 1;
+    }
+
+    Sintetizador sinte;
+    FuenteMidi fuente(lector);
+    std::atomic<bool> terminar{false};
+
+    // La pantalla es opcional: sin ella solo se pierde la visualización
+    bool hayPantalla = pantalla.abrir();
+    if (hayPantalla) visual.iniciar(pantalla);
+    std::thread leds(seguirConLeds, std::ref(matriz), ruta, std::cref(salida), std::ref(terminar));
+
+    std::cout << "Reproduciendo: " << ruta << " (" << lector.numPistas() << " pistas)\n";
+
+    int frames = std::min(int(salida.tamPeriodo()), MAX_PERIODO);
+    int16_t buffer[MAX_PERIODO];
+    uint64_t reloj = 0;
+    bool soltadas = false;
+
+    while (!fuente.fin() || sinte.vocesActivas() > 0) {
+        renderConEventos(sinte, fuente, reloj, buffer, frames);
+        visual.publicarNivel(nivelPico(buffer, frames));
+        if (!salida.escribir(buffer, frames)) break;
+        reloj += frames;
+        // A una nota sin note off se la suelta cuando termina el archivo;
+        // si no, sonaría para siempre y no se saldría nunca
+        if (!soltadas && fuente.fin() && reloj >= lector.micros() * FRECUENCIA_MUESTREO / 1000000) {
+            sinte.apagarTodas();
+            soltadas = true;
+        }
+    }
+
+    salida.drenar();
+    terminar = true;
+    leds.join();
+    if (hayPantalla) {
+        visual.detener();
+        visual.imprimirEstadisticas();
+        pantalla.cerrar();
+    }
+
+    matriz.apagarLeds();
+    salida.cerrar();
+    matriz.cerrar();
+    return 0;
+}
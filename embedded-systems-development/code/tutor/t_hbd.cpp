@@ -7,6 +7,10 @@
 #include <csignal>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include "canciones.h"
+#include "../oled/pantalla.h"
+#include "../oled/fuente.h"
+#include "../piano/registro.h"
 
 #define CHIPNAME "gpiochip0"
 #define CONSUMER "tutor-estrellita"
@@ -33,12 +37,7 @@ const char* notes[5][5] = {
     {"E4",  "A4",  "D5",  "G5",  "C6"}
 };
 
-const std::vector<std::string> melodia = {
-    "C4", "C4", "D4", "C4", "F4", "E4",
-    "C4", "C4", "D4", "C4", "G4", "F4",
-    "C4", "C4", "C5", "A4", "F4", "E4", "D4",
-    "A#4", "A#4", "A4", "F4", "G4", "F4"
-};
+const std::vector<std::string>& melodia = hbd.notas;
 
 gpiod_chip *chip;
 gpiod_line *serOut, *clkOut, *latchOut;
@@ -46,6 +45,9 @@ gpiod_line *serIn, *clkIn, *latchIn;
 gpiod_line *serCol, *clkCol, *latchCol;
 gpiod_line *serRow, *clkRow, *latchRow;
 
+Pantalla pantalla;
+bool hayPantalla = false;
+
 std::map<std::string, pid_t> procesosActivos;
 std::map<std::string, std::pair<int, int>> noteToPosition;
 
@@ -167,6 +169,16 @@ void lightNote(std::string nota) {
     shiftOut(serRow, clkRow, latchRow, rowMask);
 }
 
+// Debajo de la imagen de la canción (que ya puso el menú) van la nota que
+// toca y el avance
+void mostrarAvance(const std::string& nota, size_t indice) {
+    if (!hayPantalla) return;
+    std::string avance = std::to_string(indice + 1) + "/" + std::to_string(melodia.size());
+    escribirCampo(pantalla, 2, CAMPO_TUTOR_R, CARACTERES_LINEA, ("Toca " + nota).c_str());
+    escribirCampo(pantalla, 2, CAMPO_TUTOR_PROGRESO_R, CARACTERES_LINEA, avance.c_str());
+    pantalla.enviar(false);
+}
+
 int main() {
     if (!setup()) {
         std::cerr << "Error al inicializar GPIO\n";
@@ -177,9 +189,15 @@ int main() {
         for (int row = 0; row < 5; ++row)
             noteToPosition[notes[col][row]] = {col, row};
 
-    for (const auto& nota : melodia) {
-        std::cout << "Toca la nota: " << nota << std::endl;
+    hayPantalla = pantalla.abrir();
+    Registro::global().iniciar();
+
+    for (size_t i = 0; i < melodia.size(); ++i) {
+        const std::string& nota = melodia[i];
+        int n = indiceNota(nota);
+        registrar(REG_TUTOR_ESPERA, n, int32_t(i + 1), int32_t(melodia.size()), nombreNota(n));
         lightNote(nota);
+        mostrarAvance(nota, i);
 
         bool notaPresionada = false;
         std::map<std::string, bool> estadoAnterior;
@@ -221,7 +239,9 @@ int main() {
     apagarTodas();
     shiftOut(serCol, clkCol, latchCol, 0);
     shiftOut(serRow, clkRow, latchRow, 0);
+    if (hayPantalla) pantalla.cerrar();
     gpiod_chip_close(chip);
+    Registro::global().detener();
     return 0;
 }
 